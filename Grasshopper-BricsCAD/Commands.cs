@@ -336,5 +336,34 @@ namespace GH_BC
         GhBcConnection.GrasshopperDataExtension.Update(docExt);
     }
 
+    [CommandMethod("GhCacheStats")]
+    public static void GhCacheStats()
+    {
+      var activeDoc = Application.DocumentManager.MdiActiveDocument;
+      var docExt = GhBcConnection.GrasshopperDataExtension.GrasshopperDataManager(activeDoc);
+      if (docExt == null)
+        return;
+
+      var definitions = docExt.DefinitionManager;
+      var solutions = docExt.Solutions;
+      var editor = activeDoc.Editor;
+      editor.WriteMessage("\nDefinition pool: {0} hits, {1} misses, {2:F0} ms warm-up, {3} files open in all drawings",
+                          definitions.PoolHits, definitions.PoolMisses, definitions.WarmUpTime.TotalMilliseconds,
+                          GhDefinitionStore.Count);
+      editor.WriteMessage("\nSolution cache: {0} entries, {1:F1} MB held, {2:P1} hit rate ({3} hits, {4} from disk, {5} misses)",
+                          solutions.Count, solutions.BytesHeld / (1024.0 * 1024.0), solutions.HitRate,
+                          solutions.Hits, solutions.DiskHits, solutions.Misses);
+      if (!string.IsNullOrEmpty(solutions.DiskPath))
+        editor.WriteMessage("\nSolution store: {0} files, {1:F1} MB of {2:F0} MB on disk in {3}",
+                            solutions.DiskCount, solutions.DiskBytes / (1024.0 * 1024.0),
+                            solutions.MaxDiskBytes / (1024.0 * 1024.0), solutions.DiskPath);
+      editor.WriteMessage("\nBake: {0} entities in {1:F0} ms, {2:F0} entities/s",
+                          Components.BakeComponent.BakedEntities, Components.BakeComponent.BakeTime.TotalMilliseconds,
+                          Components.BakeComponent.EntitiesPerSecond);
+      editor.WriteMessage("\nReference geometry: {0} entries, {1:F1} MB held ({2} hits, {3} misses)",
+                          Types.ReferenceGeometryCache.Count, Types.ReferenceGeometryCache.BytesHeld / (1024.0 * 1024.0),
+                          Types.ReferenceGeometryCache.Hits, Types.ReferenceGeometryCache.Misses);
+    }
+
   }
 }
@@ -33,15 +33,24 @@ namespace GH_BC
     }
     static public _OdGe.Point3d[] ToHost(this IList<Point3f> points)
     {
-      return points.Select(p => p.ToHost()).ToArray();
+      var res = new _OdGe.Point3d[points.Count];
+      for (int i = 0; i < res.Length; ++i)
+        res[i] = points[i].ToHost();
+      return res;
     }
     static public _OdGe.Point3d[] ToHost(this IList<Point3d> points)
     {
-      return points.Select(p => p.ToHost()).ToArray();
+      var res = new _OdGe.Point3d[points.Count];
+      for (int i = 0; i < res.Length; ++i)
+        res[i] = points[i].ToHost();
+      return res;
     }
     static public _OdGe.Vector3d[] ToHost(this IList<Vector3f> points)
     {
-      return points.Select(v => v.ToHost()).ToArray();
+      var res = new _OdGe.Vector3d[points.Count];
+      for (int i = 0; i < res.Length; ++i)
+        res[i] = points[i].ToHost();
+      return res;
     }
     static public _OdCm.EntityColor ToHost(this Color c)
     {
@@ -53,14 +62,86 @@ namespace GH_BC
     }
     static public _OdGe.IntegerCollection ToHost(this IList<MeshFace> faces)
     {
-      return faces.Aggregate(new _OdGe.IntegerCollection(4 * faces.Count), (col, face) =>
+      int size = 0;
+      for (int i = 0; i < faces.Count; ++i)
+        size += FaceListSize(faces[i]);
+
+      var res = new int[size];
+      int pos = 0;
+      for (int i = 0; i < faces.Count; ++i)
+        pos = AppendFace(res, pos, faces[i]);
+      return new _OdGe.IntegerCollection(res);
+    }
+    #region Mesh lists
+    // The mesh lists below fetch their data with a single native call, the generic IList overloads
+    // above go through the list indexer, which is a native call per element for Rhino mesh lists.
+    static public _OdGe.Point3d[] ToHost(this Rhino.Geometry.Collections.MeshVertexList vertices)
+    {
+      var xyz = vertices.ToFloatArray();
+      var res = new _OdGe.Point3d[xyz.Length / 3];
+      for (int i = 0, j = 0; i < res.Length; ++i, j += 3)
+        res[i] = new _OdGe.Point3d(xyz[j], xyz[j + 1], xyz[j + 2]);
+      return res;
+    }
+    static public _OdGe.Vector3d[] ToHost(this Rhino.Geometry.Collections.MeshVertexNormalList normals)
+    {
+      var xyz = normals.ToFloatArray();
+      var res = new _OdGe.Vector3d[xyz.Length / 3];
+      for (int i = 0, j = 0; i < res.Length; ++i, j += 3)
+        res[i] = new _OdGe.Vector3d(xyz[j], xyz[j + 1], xyz[j + 2]);
+      return res;
+    }
+    static public _OdCm.EntityColor[] ToHost(this Rhino.Geometry.Collections.MeshVertexColorList colors)
+    {
+      var argb = colors.ToARGBArray();
+      var res = new _OdCm.EntityColor[argb.Length];
+      for (int i = 0; i < res.Length; ++i)
+        res[i] = new _OdCm.EntityColor((byte) (argb[i] >> 16), (byte) (argb[i] >> 8), (byte) argb[i]);
+      return res;
+    }
+    static public _OdGe.IntegerCollection ToHost(this Rhino.Geometry.Collections.MeshFaceList faces)
+    {
+      // four indices per face, C == D for triangles
+      var abcd = faces.ToIntArray(false);
+      int size = 0;
+      for (int j = 0; j < abcd.Length; j += 4)
+        size += abcd[j + 2] == abcd[j + 3] ? 4 : 5;
+
+      var res = new int[size];
+      int pos = 0;
+      for (int j = 0; j < abcd.Length; j += 4)
+      {
+        bool isTriangle = abcd[j + 2] == abcd[j + 3];
+        res[pos++] = isTriangle ? 3 : 4;
+        res[pos++] = abcd[j];
+        res[pos++] = abcd[j + 1];
+        res[pos++] = abcd[j + 2];
+        if (!isTriangle)
+          res[pos++] = abcd[j + 3];
+      }
+      return new _OdGe.IntegerCollection(res);
+    }
+    static private int FaceListSize(MeshFace face) => face.IsQuad ? 5 : face.IsTriangle ? 4 : 0;
+    static private int AppendFace(int[] faceList, int pos, MeshFace face)
+    {
+      if (face.IsQuad)
+      {
+        faceList[pos++] = 4;
+        faceList[pos++] = face.A;
+        faceList[pos++] = face.B;
+        faceList[pos++] = face.C;
+        faceList[pos++] = face.D;
+      }
+      else if (face.IsTriangle)
       {
-        col.AddRange(face.IsQuad ? new int[] { 4, face.A, face.B, face.C, face.D }
-                                       : face.IsTriangle ? new int[] { 3, face.A, face.B, face.C }
-                                                         : new int[] { });
-        return col;
-      });
+        faceList[pos++] = 3;
+        faceList[pos++] = face.A;
+        faceList[pos++] = face.B;
+        faceList[pos++] = face.C;
+      }
+      return pos;
     }
+    #endregion
 
     //ToRhino
     static public Rhino.UnitSystem ToRhino(this _OdDb.UnitsValue units)
@@ -157,60 +238,174 @@ namespace GH_BC
     {
       return crv.GetGeCurve().ToRhino();
     }
-    static public GeometryBase ToRhino(this _OdDb.Entity ent)
+    // entity created directly from a Grasshopper value, of the type the Rhino importer creates for it,
+    // null for geometry which needs the importer (polylines among them, it picks their polyline type)
+    static public _OdDb.Entity ToHostEntity(object geometry)
     {
-      if (ent is _OdDb.Curve curve)
+      switch (geometry)
       {
-        var geometry = curve.ToRhino();
-        if (geometry != null)
-          return geometry;
+        case Point3d point: return new _OdDb.DBPoint(point.ToHost());
+        case Line line: return new _OdDb.Line(line.From.ToHost(), line.To.ToHost());
+        case LineCurve lineCurve: return ToHostEntity(lineCurve.Line);
+        case Circle circle: return new _OdDb.Circle(circle.Center.ToHost(), circle.Normal.ToHost(), circle.Radius);
+        case Arc arc:
+          {
+            if (!arc.IsValid)
+              return null;
+            if (arc.IsCircle)
+              return ToHostEntity(new Circle(arc.Plane, arc.Radius));
+            //arc angles are measured from the x axis of the OCS of the normal
+            var normal = arc.Plane.Normal.ToHost();
+            var ocsXAxis = _OdGe.Vector3d.XAxis.TransformBy(_OdGe.Matrix3d.PlaneToWorld(normal));
+            var startAngle = ocsXAxis.GetAngleTo((arc.StartPoint - arc.Center).ToHost(), normal);
+            return new _OdDb.Arc(arc.Center.ToHost(), normal, arc.Radius, startAngle, startAngle + arc.Angle);
+          }
+        case ArcCurve arcCurve: return ToHostEntity(arcCurve.Arc);
       }
-      string tmpPath = Path.Combine(Path.GetTempPath(), "BricsCAD", "torhino.3dm");
-      using (var aObj = new _OdDb.DBObjectCollection() { ent })
+      return null;
+    }
+    static private Mesh ToRhino(this _OdDb.SubDMesh subDMesh)
+    {
+      // smoothed meshes are left to the exporter, which knows how to evaluate them
+      if (subDMesh.SmoothLevel != 0)
+        return null;
+
+      var mesh = new Mesh();
+      var vertices = subDMesh.Vertices;
+      mesh.Vertices.Capacity = vertices.Count;
+      foreach (_OdGe.Point3d p in vertices)
+        mesh.Vertices.Add(p.X, p.Y, p.Z);
+
+      var faces = subDMesh.FaceArray;
+      for (int i = 0; i < faces.Count; i += faces[i] + 1)
       {
-        if (_OdRx.ErrorStatus.OK != Bricscad.Rhino.RhinoUtilityFunctions.ExportRhinoFile(aObj, tmpPath))
-          return null;
+        int count = faces[i];
+        if (count == 4)
+          mesh.Faces.AddFace(faces[i + 1], faces[i + 2], faces[i + 3], faces[i + 4]);
+        else
+        {
+          for (int j = 1; j + 1 < count; ++j)
+            mesh.Faces.AddFace(faces[i + 1], faces[i + 1 + j], faces[i + 2 + j]);
+        }
       }
-      return ExtractGeometryFromFile(tmpPath);
+      mesh.Normals.ComputeNormals();
+      mesh.Compact();
+      return mesh;
+    }
+    // geometry converted in process, null for entities which need the Rhino exporter
+    static private GeometryBase ToRhinoDirect(this _OdDb.Entity ent)
+    {
+      switch (ent)
+      {
+        case _OdDb.Curve curve: return curve.ToRhino();
+        case _OdDb.SubDMesh subDMesh: return subDMesh.ToRhino();
+      }
+      return null;
+    }
+    static private bool IsDirectlyConvertible(_OdDb.ObjectId id)
+    {
+      return DatabaseUtils.IsCurve(id) ||
+             id.ObjectClass.IsDerivedFrom(_OdRx.RXObject.GetClass(typeof(_OdDb.SubDMesh)));
+    }
+    static public GeometryBase ToRhino(this _OdDb.Entity ent)
+    {
+      var geometry = ent.ToRhinoDirect();
+      if (geometry != null)
+        return geometry;
+
+      using (var aObj = new _OdDb.DBObjectCollection() { ent })
+        return ExportGeometry(path => Bricscad.Rhino.RhinoUtilityFunctions.ExportRhinoFile(aObj, path), 1)?[0];
     }
     static public GeometryBase ToRhino(this _OdDb.ObjectId id)
     {
-      if (DatabaseUtils.IsCurve(id))
+      using (var aId = new _OdDb.ObjectIdCollection() { id })
+        return aId.ToRhino()[0];
+    }
+    // converts all entities at once, curves and meshes in process and everything else in a single export
+    static public GeometryBase[] ToRhino(this _OdDb.ObjectIdCollection ids)
+    {
+      var res = new GeometryBase[ids.Count];
+      var toExport = new _OdDb.ObjectIdCollection();
+      var exportIndex = new List<int>();
+      for (int i = 0; i < ids.Count; ++i)
       {
-        using (var transaction = id.Database.TransactionManager.StartTransaction())
+        var id = ids[i];
+        if (id.IsNull)
+          continue;
+
+        if (IsDirectlyConvertible(id))
         {
-          using (var dbCurve = transaction.GetObject(id, _OdDb.OpenMode.ForRead) as _OdDb.Curve)
+          using (var transaction = id.Database.TransactionManager.StartTransaction())
           {
-            var geometry = dbCurve?.ToRhino();
-            if (geometry != null)
-              return geometry;
+            using (var ent = transaction.GetObject(id, _OdDb.OpenMode.ForRead) as _OdDb.Entity)
+            {
+              res[i] = ent?.ToRhinoDirect();
+            }
           }
+          if (res[i] != null)
+            continue;
         }
+        toExport.Add(id);
+        exportIndex.Add(i);
       }
 
-      string tmpPath = Path.Combine(Path.GetTempPath(), "BricsCAD", "torhino.3dm");
-      using (var aId = new _OdDb.ObjectIdCollection() { id })
+      if (toExport.Count == 0)
+        return res;
+
+      //the exporter keeps the order of the ids but writes nothing identifying them, so the objects read
+      //back are matched by position, which is only done when as many objects as ids were read back
+      var exported = ExportGeometry(path => Bricscad.Rhino.RhinoUtilityFunctions.ExportRhinoFile(toExport, path), toExport.Count);
+      if (exported != null)
       {
-        if (_OdRx.ErrorStatus.OK != Bricscad.Rhino.RhinoUtilityFunctions.ExportRhinoFile(aId, tmpPath))
-          return null;
+        for (int i = 0; i < exportIndex.Count; ++i)
+          res[exportIndex[i]] = exported[i];
+      }
+      else if (toExport.Count > 1)
+      {
+        //some entity gave several objects or none, export them one by one instead
+        for (int i = 0; i < exportIndex.Count; ++i)
+        {
+          using (var aId = new _OdDb.ObjectIdCollection() { toExport[i] })
+            res[exportIndex[i]] = ExportGeometry(path => Bricscad.Rhino.RhinoUtilityFunctions.ExportRhinoFile(aId, path), 1)?[0];
+        }
       }
-      return ExtractGeometryFromFile(tmpPath);
+      return res;
     }
-    static private GeometryBase ExtractGeometryFromFile(string filename)
+    // runs the Rhino exporter into a private temporary file and reads the objects back, returns null
+    // unless one geometry per exported entity was read back (a single entity gives its first object)
+    static private GeometryBase[] ExportGeometry(System.Func<string, _OdRx.ErrorStatus> export, int expectedCount)
     {
-      GeometryBase geometry = null;
-      using (var rhinoFile = Rhino.FileIO.File3dm.Read(filename))
+      string tmpDir = Path.Combine(Path.GetTempPath(), "BricsCAD");
+      string tmpPath = Path.Combine(tmpDir, "torhino_" + System.Guid.NewGuid().ToString("N") + ".3dm");
+      try
       {
-        foreach (var fileObj in rhinoFile.Objects)
+        Directory.CreateDirectory(tmpDir);
+        if (_OdRx.ErrorStatus.OK != export(tmpPath))
+          return null;
+
+        var geometries = new List<GeometryBase>(expectedCount);
+        using (var rhinoFile = Rhino.FileIO.File3dm.Read(tmpPath))
         {
-          if (fileObj.Geometry is InstanceReferenceGeometry)
-            continue;
-          geometry = fileObj.Geometry?.Duplicate();
-          if (geometry != null)
-            break;
+          if (rhinoFile == null)
+            return null;
+
+          foreach (var fileObj in rhinoFile.Objects)
+          {
+            if (fileObj.Geometry is InstanceReferenceGeometry)
+              continue;
+            var geometry = fileObj.Geometry?.Duplicate();
+            if (geometry != null)
+              geometries.Add(geometry);
+            if (expectedCount == 1 && geometries.Count == 1)
+              break;
+          }
         }
+        return geometries.Count == expectedCount ? geometries.ToArray() : null;
+      }
+      finally
+      {
+        try { File.Delete(tmpPath); } catch (System.Exception) { }
       }
-      return geometry;
     }
   }
 }
@@ -10,7 +10,36 @@ namespace GH_BC
   {
     public const string Wirframe = "Wireframe";
     public const string Realistic = "Realistic";
+    // resolved visual style ids per database, dropped when its visual style dictionary changes
+    private static Dictionary<Database, Dictionary<string, ObjectId>> _visualStyles = new Dictionary<Database, Dictionary<string, ObjectId>>();
     public static ObjectId VisualStyleId(Database database, string visualStyleName)
+    {
+      if (!_visualStyles.TryGetValue(database, out var visualStyles))
+      {
+        visualStyles = new Dictionary<string, ObjectId>();
+        _visualStyles.Add(database, visualStyles);
+        database.ObjectModified += OnVisualStyleDictionaryModified;
+      }
+      if (!visualStyles.TryGetValue(visualStyleName, out var res))
+      {
+        res = FindVisualStyleId(database, visualStyleName);
+        visualStyles.Add(visualStyleName, res);
+      }
+      return res;
+    }
+    public static void ReleaseVisualStyles(Database database)
+    {
+      if (_visualStyles.Remove(database))
+        database.ObjectModified -= OnVisualStyleDictionaryModified;
+    }
+    private static void OnVisualStyleDictionaryModified(object sender, ObjectEventArgs e)
+    {
+      var database = sender as Database;
+      if (database != null && e.DBObject.ObjectId == database.VisualStyleDictionaryId &&
+          _visualStyles.TryGetValue(database, out var visualStyles))
+        visualStyles.Clear();
+    }
+    private static ObjectId FindVisualStyleId(Database database, string visualStyleName)
     {
       using (var transaction = database.TransactionManager.StartTransaction())
       {
@@ -58,7 +87,7 @@ namespace GH_BC
       }
       return res + fsp.SubentId.IndexPtr.ToString();
     }
-    public static ObjectIdCollection AppendObjectsToDatabase(DBObjectCollection objects, Database database, bool createUndo)
+    public static ObjectIdCollection AppendObjectsToDatabase(DBObjectCollection objects, Database database, bool createUndo, int chunkSize = 0)
     {
       var objIds = new ObjectIdCollection();
       if (objects.Count == 0)
@@ -67,20 +96,29 @@ namespace GH_BC
       if (createUndo)
         database.StartUndoRecord();
 
-      using (var transaction = database.TransactionManager.StartTransaction())
+      // chunks are committed one by one, so a large bake does not keep every entity open till the end;
+      // inside another transaction they are only committed into it, and stay open until it ends
+      var entities = objects.OfType<Entity>().ToList();
+      if (chunkSize <= 0)
+        chunkSize = entities.Count;
+      for (int first = 0; first < entities.Count; first += chunkSize)
       {
-        using (var blockTable = transaction.GetObject(database.BlockTableId, OpenMode.ForRead) as BlockTable)
+        using (var transaction = database.TransactionManager.StartTransaction())
         {
-          using (var blockTableRecord = transaction.GetObject(blockTable[BlockTableRecord.ModelSpace], OpenMode.ForWrite) as BlockTableRecord)
+          using (var blockTable = transaction.GetObject(database.BlockTableId, OpenMode.ForRead) as BlockTable)
           {
-            foreach (var ent in objects.OfType<Entity>())
+            using (var blockTableRecord = transaction.GetObject(blockTable[BlockTableRecord.ModelSpace], OpenMode.ForWrite) as BlockTableRecord)
             {
-              objIds.Add(blockTableRecord.AppendEntity(ent));
-              transaction.AddNewlyCreatedDBObject(ent, true);
+              int last = System.Math.Min(entities.Count, first + chunkSize);
+              for (int i = first; i < last; ++i)
+              {
+                objIds.Add(blockTableRecord.AppendEntity(entities[i]));
+                transaction.AddNewlyCreatedDBObject(entities[i], true);
+              }
             }
           }
+          transaction.Commit();
         }
-        transaction.Commit();
       }
       return objIds;
     }
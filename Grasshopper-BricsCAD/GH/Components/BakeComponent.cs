@@ -19,6 +19,9 @@ namespace GH_BC.Components
     protected string _layer = string.Empty;
     protected string _material = string.Empty;
     protected Teigha.Colors.Color _color = null;
+    public static long BakedEntities { get; private set; }
+    public static TimeSpan BakeTime { get; private set; }
+    public static double EntitiesPerSecond => BakeTime.TotalSeconds > 0.0 ? BakedEntities / BakeTime.TotalSeconds : 0.0;
     protected BakeComponent(string name, string nickname, string description, string category, string subCategory)
       : base(name, nickname, description, category, subCategory)
     { }
@@ -77,38 +80,81 @@ namespace GH_BC.Components
         ExpireSolution(true);
       }
     }
-    public _OdDb.ObjectIdCollection BakeGhGeometry(IGH_StructureEnumerator se)
+    public _OdDb.ObjectIdCollection BakeGhGeometry(IEnumerable<IGH_Goo> values)
     {
-      using (var tmpFile = new File3dm())
+      var watch = System.Diagnostics.Stopwatch.StartNew();
+      using (var entities = new _OdDb.DBObjectCollection())
       {
-        foreach (var paramValue in se)
-          AddGeometry(tmpFile, paramValue);
-        return BakeGhGeometry(tmpFile);
+        // simple geometry is created directly, the rest goes through a single Rhino import
+        using (var toImport = new File3dm())
+        {
+          var database = GhDrawingContext.LinkedDocument.Database;
+          var importScale = ImportScale(toImport, database);
+          foreach (var value in values)
+          {
+            var entity = Convert.ToHostEntity(value.ScriptVariable());
+            if (entity != null)
+            {
+              if (importScale != 1.0)
+                entity.TransformBy(Teigha.Geometry.Matrix3d.Scaling(importScale, Teigha.Geometry.Point3d.Origin));
+              entities.Add(entity);
+            }
+            else
+              AddGeometry(toImport, value);
+          }
+          if (toImport.Objects.Count != 0)
+            ImportGeometry(toImport, entities);
+        }
+        if (entities.Count == 0)
+          return null;
+
+        foreach (var entity in entities.OfType<_OdDb.Entity>())
+          AssignTraits(entity);
+        var dbObjects = DatabaseUtils.AppendObjectsToDatabase(entities, GhDrawingContext.LinkedDocument.Database, false, GhDataSettings.BakeChunkSize);
+        BakedEntities += dbObjects.Count;
+        BakeTime += watch.Elapsed;
+        return dbObjects;
       }
     }
-    protected _OdDb.ObjectIdCollection BakeGhGeometry(File3dm tmpFile)
+    // the importer scales from the units of the file to those of the drawing, entities created directly get the same
+    private static double ImportScale(File3dm file, _OdDb.Database database)
     {
-      _OdDb.ObjectIdCollection dbObjects = null;
-      if (tmpFile.Objects.Count != 0)
+      var fileUnits = file.Settings.ModelUnitSystem;
+      var drawingUnits = database.Insunits.ToRhino();
+      if (fileUnits == Rhino.UnitSystem.None || drawingUnits == Rhino.UnitSystem.None)
+        return 1.0;
+      return Rhino.RhinoMath.UnitScale(fileUnits, drawingUnits);
+    }
+    private static void ImportGeometry(File3dm file, _OdDb.DBObjectCollection entities)
+    {
+      string tmpDir = Path.Combine(Path.GetTempPath(), "BricsCAD");
+      string tmpPath = Path.Combine(tmpDir, "fromrhino_" + Guid.NewGuid().ToString("N") + ".3dm");
+      try
       {
-        string tmpPath = Path.Combine(Path.GetTempPath(), "BricsCAD", "fromrhino.3dm");
-        tmpFile.Write(tmpPath, new File3dmWriteOptions());
+        Directory.CreateDirectory(tmpDir);
+        file.Write(tmpPath, new File3dmWriteOptions());
         using (var objects = Bricscad.Rhino.RhinoUtilityFunctions.ImportRhinoFile(tmpPath, true))
         {
-          foreach (var entity in objects.OfType<_OdDb.Entity>())
-            AssignTraits(entity);
-          dbObjects = DatabaseUtils.AppendObjectsToDatabase(objects, GhDrawingContext.LinkedDocument.Database, false);
+          foreach (_OdDb.DBObject obj in objects)
+            entities.Add(obj);
         }
       }
-      return dbObjects;
+      finally
+      {
+        try { File.Delete(tmpPath); } catch (Exception) { }
+      }
     }
     protected void AssignTraits(_OdDb.Entity entity)
     {
-      entity.UpgradeOpen();
+      // entities which are not in the database yet take their traits without reopening
+      bool reopen = !entity.ObjectId.IsNull && !entity.IsWriteEnabled;
+      if (reopen)
+        entity.UpgradeOpen();
       entity.Layer = _layer;
       entity.Color = _color;
       entity.Material = _material;
-      entity.DowngradeOpen();
+      if (reopen)
+        entity.DowngradeOpen();
     }
     protected void AddGeometry(File3dm file, IGH_Goo obj)
     {
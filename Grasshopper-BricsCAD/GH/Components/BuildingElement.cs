@@ -128,11 +128,7 @@ namespace GH_BC.Components
     }
     public _OdDb.ObjectIdCollection BakeGhGeometry(IGH_GeometricGoo gg)
     {
-      using (var tmpFile = new Rhino.FileIO.File3dm())
-      {
-        AddGeometry(tmpFile, gg);
-        return BakeGhGeometry(tmpFile);
-      }
+      return BakeGhGeometry(new IGH_Goo[] { gg });
     }
   }
 
@@ -33,9 +33,17 @@ namespace GH_BC.Parameters
   {
     void InitBy(List<FullSubentityPath> aSubents, string docName);
   }
+  // Params expiring exactly as NeedsToBeExpired says: when a handle of their volatile data is modified
+  // or erased, or a handle of their persistent data is appended.
+  // GhDrawingContext looks them up by handle instead of asking each of them through NeedsToBeExpired.
+  public interface IGH_BcHandleSubscriber : IGH_BcParam
+  {
+    IEnumerable<Handle> VolatileHandles { get; }
+    IEnumerable<Handle> PersistentHandles { get; }
+  }
 
   public abstract class GH_PersistentGeometryParam<X> :
-  Grasshopper.Kernel.GH_PersistentGeometryParam<X>, IGH_GeometryBcParam
+  Grasshopper.Kernel.GH_PersistentGeometryParam<X>, IGH_GeometryBcParam, IGH_BcHandleSubscriber
   where X : class, IGH_BcGeometricGoo
   {
     public GH_PersistentGeometryParam(GH_InstanceDescription nTag) : base(nTag) { }
@@ -118,6 +126,13 @@ namespace GH_BC.Parameters
     }
     #endregion
 
+    #region IGH_BcHandleSubscriber
+    public IEnumerable<Handle> VolatileHandles => VolatileData.AllData(true).OfType<Types.IGH_BcGeometricGoo>()
+                                                              .Select(data => data.PersistentRef);
+    public IEnumerable<Handle> PersistentHandles => PersistentData.AllData(true).OfType<Types.IGH_BcGeometricGoo>()
+                                                                  .Select(data => data.PersistentRef);
+    #endregion
+
     protected override void OnVolatileDataCollected()
     {
       if (SourceCount == 0)
@@ -135,6 +150,7 @@ namespace GH_BC.Parameters
             }
           }
         }
+        Types.ReferenceGeometryCache.Prefetch(m_data.AllData(true).OfType<Types.IGH_BcGeometricGoo>().Select(data => data.Reference));
       }
       base.OnVolatileDataCollected();
     }
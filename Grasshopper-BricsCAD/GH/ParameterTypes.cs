@@ -61,27 +61,15 @@ namespace GH_BC.Types
       return IsValid;
     }
 
-    public Rhino.Geometry.GeometryBase getGeometry()
+    // returns a copy the caller owns, the converted geometry itself is shared through ReferenceGeometryCache
+    public Rhino.Geometry.GeometryBase getGeometry() => CachedGeometry(out var _)?.Duplicate();
+    // the shared geometry, casts wrap it as is since Grasshopper duplicates goo geometry before modifying it
+    protected Rhino.Geometry.GeometryBase CachedGeometry(out Rhino.Geometry.BoundingBox bbox)
     {
+      bbox = Rhino.Geometry.BoundingBox.Empty;
       if (Value.IsNullObjectLink())
         return null;
-      Rhino.Geometry.GeometryBase geom = null;
-      if (Value.IsSubentity())
-      {
-        using (var transaction = ObjectId.Database.TransactionManager.StartTransaction())
-        {
-          using (var entity = transaction.GetObject(ObjectId, OpenMode.ForRead) as Entity)
-          {
-            using (var subent = entity?.GetSubentity(Value))
-            {
-              geom = subent?.ToRhino();
-            }
-          }
-        }
-      }
-      else
-        geom = ObjectId.ToRhino();
-      return geom;
+      return ReferenceGeometryCache.Find(Value, out bbox);
     }
 
     public override sealed IGH_GeometricGoo DuplicateGeometry() => (IGH_BcGeometricGoo) MemberwiseClone();
@@ -130,14 +118,12 @@ namespace GH_BC.Types
     }
     public override Rhino.Geometry.BoundingBox GetBoundingBox(Rhino.Geometry.Transform xform)
     {
-      var geometry = getGeometry();
+      var geometry = CachedGeometry(out var bbox);
       if (geometry == null)
         return Rhino.Geometry.BoundingBox.Empty;
 
       bool IsIdentity = xform == Rhino.Geometry.Transform.Identity;
-      
-      var bbox = IsIdentity ? geometry.GetBoundingBox(true) : geometry.GetBoundingBox(xform);
-      return bbox;
+      return IsIdentity ? bbox : geometry.GetBoundingBox(xform);
     }
   }
 
@@ -149,7 +135,7 @@ namespace GH_BC.Types
     public Vertex(FullSubentityPath fullSubentityPath, string docName) : base(fullSubentityPath, docName) { }
     public override bool CastTo<Q>(ref Q target)
     {
-      var geometry = getGeometry();
+      var geometry = CachedGeometry(out var _);
       if (typeof(Q).IsAssignableFrom(typeof(GH_Point)) && geometry is Rhino.Geometry.Point point)
       {
         target = (Q) (object) new GH_Point(point.Location);
@@ -167,7 +153,7 @@ namespace GH_BC.Types
     public Edge(FullSubentityPath fullSubentityPath, string docName) : base(fullSubentityPath, docName) { }
     public override bool CastTo<Q>(ref Q target)
     {
-      if (!(getGeometry() is Rhino.Geometry.Curve geometry))
+      if (!(CachedGeometry(out var _) is Rhino.Geometry.Curve geometry))
         return false;
 
       if (typeof(Q).IsAssignableFrom(typeof(GH_Curve)))
@@ -187,7 +173,7 @@ namespace GH_BC.Types
     public Face(FullSubentityPath fullSubentityPath, string docName) : base(fullSubentityPath, docName) { }
     public override bool CastTo<Q>(ref Q target)
     {
-      if (!(getGeometry() is Rhino.Geometry.Brep geometry))
+      if (!(CachedGeometry(out var _) is Rhino.Geometry.Brep geometry))
         return false;
 
       if (typeof(Q).IsAssignableFrom(typeof(GH_Brep)))
@@ -214,7 +200,7 @@ namespace GH_BC.Types
     {
       if (typeof(Q).IsAssignableFrom(typeof(GH_Curve)))
       {
-        if (!(getGeometry() is Rhino.Geometry.Curve geometry))
+        if (!(CachedGeometry(out var _) is Rhino.Geometry.Curve geometry))
           return false;
 
         target = (Q) (object) new GH_Curve(geometry);
@@ -232,7 +218,7 @@ namespace GH_BC.Types
     public BcEntity(FullSubentityPath fullSubentityPath, string docName) : base(fullSubentityPath, docName) { }
     public override bool CastTo<Q>(ref Q target)
     {
-      var geometry = getGeometry();
+      var geometry = CachedGeometry(out var _);
       if (geometry == null)
         return false;
 
@@ -241,9 +227,9 @@ namespace GH_BC.Types
         case Rhino.DocObjects.ObjectType.Point:
           if (typeof(Q).IsAssignableFrom(typeof(GH_Point)))
           {
-            if (!(getGeometry() is Rhino.Geometry.Point point))
+            if (!(geometry is Rhino.Geometry.Point point))
               return false;
-            target = (Q) (object) new GH_Point((geometry as Rhino.Geometry.Point).Location);
+            target = (Q) (object) new GH_Point(point.Location);
             return true;
           }
           break;
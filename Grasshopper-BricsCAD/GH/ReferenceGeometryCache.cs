@@ -0,0 +1,211 @@
+using System.Collections.Generic;
+using Teigha.DatabaseServices;
+
+namespace GH_BC.Types
+{
+  // Rhino geometry converted from referenced entities and subentities, shared by all goo
+  // (and their duplicates) pointing to the same reference. Entries carry the revision of their
+  // entity, which is bumped by reactors on every database the cache read from as soon as the entity
+  // is modified or erased, so no solve runs against a conversion from before the edit.
+  static class ReferenceGeometryCache
+  {
+    private struct Key
+    {
+      public Database Database;
+      public Handle Handle;
+      public SubentityType SubentType;
+      public long SubentIndex;
+      public override int GetHashCode() => Handle.GetHashCode() ^ ((int) SubentType << 24) ^ SubentIndex.GetHashCode();
+      public override bool Equals(object obj) => obj is Key key &&
+                                                 key.Database == Database &&
+                                                 key.Handle == Handle &&
+                                                 key.SubentType == SubentType &&
+                                                 key.SubentIndex == SubentIndex;
+    }
+    private class Entry
+    {
+      public Key Key;
+      public int Revision;
+      public Rhino.Geometry.GeometryBase Geometry;
+      public Rhino.Geometry.BoundingBox BoundingBox;
+      public long Bytes;
+    }
+    private static Dictionary<Key, LinkedListNode<Entry>> _entries = new Dictionary<Key, LinkedListNode<Entry>>();
+    private static LinkedList<Entry> _lru = new LinkedList<Entry>();
+    private static Dictionary<Database, Dictionary<Handle, int>> _revisions = new Dictionary<Database, Dictionary<Handle, int>>();
+    public static long MaxBytes { get; set; } = 128L * 1024 * 1024;
+    public static int Hits { get; private set; }
+    public static int Misses { get; private set; }
+    public static long BytesHeld { get; private set; }
+    public static int Count => _entries.Count;
+
+    // returns the shared geometry of the reference, callers must not modify it
+    public static Rhino.Geometry.GeometryBase Find(FullSubentityPath reference, out Rhino.Geometry.BoundingBox bbox)
+    {
+      var key = MakeKey(reference);
+      int revision = Revision(key.Database, key.Handle);
+      if (_entries.TryGetValue(key, out var node))
+      {
+        if (node.Value.Revision == revision)
+        {
+          _lru.Remove(node);
+          _lru.AddFirst(node);
+          ++Hits;
+          bbox = node.Value.BoundingBox;
+          return node.Value.Geometry;
+        }
+        RemoveNode(node);
+      }
+
+      ++Misses;
+      var geometry = ConvertReference(reference);
+      bbox = geometry?.GetBoundingBox(true) ?? Rhino.Geometry.BoundingBox.Empty;
+      if (geometry != null)
+        AddEntry(new Entry { Key = key, Revision = revision, Geometry = geometry, BoundingBox = bbox, Bytes = geometry.MemoryEstimate() });
+      return geometry;
+    }
+    // converts the whole-entity references missing from the cache together, so entities needing
+    // the Rhino exporter go through a single export per database instead of one each
+    public static void Prefetch(IEnumerable<FullSubentityPath> references)
+    {
+      var pending = new Dictionary<Database, List<Key>>();
+      var pendingIds = new Dictionary<Database, ObjectIdCollection>();
+      var seen = new HashSet<Key>();
+      foreach (var reference in references)
+      {
+        if (reference.IsNullObjectLink() || reference.IsSubentity())
+          continue;
+
+        var key = MakeKey(reference);
+        if (!seen.Add(key))
+          continue;
+        if (_entries.TryGetValue(key, out var node) && node.Value.Revision == Revision(key.Database, key.Handle))
+          continue;
+        if (!pending.TryGetValue(key.Database, out var keys))
+        {
+          keys = new List<Key>();
+          pending.Add(key.Database, keys);
+          pendingIds.Add(key.Database, new ObjectIdCollection());
+        }
+        keys.Add(key);
+        pendingIds[key.Database].Add(reference.InsertId());
+      }
+
+      foreach (var databaseKeys in pending)
+      {
+        var keys = databaseKeys.Value;
+        using (var ids = pendingIds[databaseKeys.Key])
+        {
+          var geometries = ids.ToRhino();
+          for (int i = 0; i < keys.Count; ++i)
+          {
+            ++Misses;
+            if (_entries.TryGetValue(keys[i], out var node))
+              RemoveNode(node);
+            var geometry = geometries[i];
+            if (geometry == null)
+              continue;
+
+            var bbox = geometry.GetBoundingBox(true);
+            AddEntry(new Entry { Key = keys[i], Revision = Revision(keys[i].Database, keys[i].Handle), Geometry = geometry, BoundingBox = bbox, Bytes = geometry.MemoryEstimate() });
+          }
+        }
+      }
+    }
+    public static void Invalidate(Database database, Handle handle)
+    {
+      if (!_revisions.TryGetValue(database, out var revisions))
+        return;
+
+      revisions.TryGetValue(handle, out int revision);
+      revisions[handle] = revision + 1;
+    }
+    public static void Clear()
+    {
+      foreach (var database in new List<Database>(_revisions.Keys))
+        Clear(database);
+      _entries.Clear();
+      _lru.Clear();
+      BytesHeld = 0;
+    }
+    public static void Clear(Database database)
+    {
+      if (!_revisions.Remove(database))
+        return;
+
+      database.ObjectModified -= OnObjectModified;
+      database.ObjectErased -= OnObjectErased;
+      var nodes = new List<LinkedListNode<Entry>>();
+      for (var node = _lru.First; node != null; node = node.Next)
+      {
+        if (node.Value.Key.Database == database)
+          nodes.Add(node);
+      }
+      nodes.ForEach(RemoveNode);
+    }
+    // entries are only added for databases which are watched, so every later edit is seen
+    private static int Revision(Database database, Handle handle)
+    {
+      if (!_revisions.TryGetValue(database, out var revisions))
+      {
+        revisions = new Dictionary<Handle, int>();
+        _revisions.Add(database, revisions);
+        database.ObjectModified += OnObjectModified;
+        database.ObjectErased += OnObjectErased;
+      }
+      revisions.TryGetValue(handle, out int revision);
+      return revision;
+    }
+    private static void OnObjectModified(object sender, ObjectEventArgs e)
+    {
+      if (e.DBObject is Entity)
+        Invalidate(e.DBObject.Database, e.DBObject.ObjectId.Handle);
+    }
+    private static void OnObjectErased(object sender, ObjectErasedEventArgs e)
+    {
+      if (e.DBObject is Entity)
+        Invalidate(e.DBObject.Database, e.DBObject.ObjectId.Handle);
+    }
+    private static Key MakeKey(FullSubentityPath reference)
+    {
+      var id = reference.InsertId();
+      return new Key
+      {
+        Database = id.Database,
+        Handle = id.Handle,
+        SubentType = reference.SubentId.Type,
+        SubentIndex = reference.SubentId.IndexPtr.ToInt64()
+      };
+    }
+    private static Rhino.Geometry.GeometryBase ConvertReference(FullSubentityPath reference)
+    {
+      var objectId = reference.InsertId();
+      if (!reference.IsSubentity())
+        return objectId.ToRhino();
+
+      using (var transaction = objectId.Database.TransactionManager.StartTransaction())
+      {
+        using (var entity = transaction.GetObject(objectId, OpenMode.ForRead) as Entity)
+        {
+          using (var subent = entity?.GetSubentity(reference))
+          {
+            return subent?.ToRhino();
+          }
+        }
+      }
+    }
+    private static void AddEntry(Entry entry)
+    {
+      _entries[entry.Key] = _lru.AddFirst(entry);
+      BytesHeld += entry.Bytes;
+      while (BytesHeld > MaxBytes && _lru.Count > 1)
+        RemoveNode(_lru.Last);
+    }
+    private static void RemoveNode(LinkedListNode<Entry> node)
+    {
+      _lru.Remove(node);
+      _entries.Remove(node.Value.Key);
+      BytesHeld -= node.Value.Bytes;
+    }
+  }
+}
@@ -1,107 +1,386 @@
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
+using System.Threading.Tasks;
 using GH_IO.Serialization;
 using Grasshopper.Kernel;
 using _BcAp = Bricscad.ApplicationServices;
 using _OdRx = Teigha.Runtime;
 using _OdDb = Teigha.DatabaseServices;
+using _OdGe = Teigha.Geometry;
 using GH_BC.Visualization;
 
 namespace GH_BC
 {
-  class GhDefinitionManager
+  // Per drawing view on GhDefinitionStore: resolves definition names against the drawing's search
+  // folders and holds a reference on every file it resolved.
+  class GhDefinitionManager : IDisposable
   {
+    // definition files are read concurrently while a drawing opens, reading is mostly waiting for the disk
+    private const int MaxPrefetchThreads = 16;
     private Dictionary<string, string> _nameToPath = new Dictionary<string, string>();
-    private Dictionary<string, GH_Archive> _docs = new Dictionary<string, GH_Archive>();
+    // files this drawing holds a reference on in GhDefinitionStore
+    private HashSet<string> _acquired = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+    private class PrefetchResult
+    {
+      public string Name;
+      public string FilePath;
+      public GH_Archive Archive;
+      public string Hash;
+    }
+    private Task<PrefetchResult[]> _prefetch;
+    private string _prefetchMissKey;
+    private string[] _prefetchSearchPaths;
+    public bool IsPrefetching => _prefetch != null && !_prefetch.IsCompleted;
+    // read in the background and waiting for CompletePrefetch to publish them
+    public bool HasPrefetchResults => _prefetch != null && _prefetch.IsCompleted;
+    // lookups that found nothing, keyed by name and extra search path, valid until a file appears
+    // in a watched folder or SRCHPATH changes
+    private HashSet<string> _missing = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+    private string _srchPath;
+    private Dictionary<string, FileSystemWatcher> _watchers = new Dictionary<string, FileSystemWatcher>(StringComparer.OrdinalIgnoreCase);
+    // raised on watcher threads, handled by ProcessFileChanges on the UI thread
+    private ConcurrentQueue<KeyValuePair<WatcherChangeTypes, string>> _fileChanges = new ConcurrentQueue<KeyValuePair<WatcherChangeTypes, string>>();
+    public bool HasFileChanges => !_fileChanges.IsEmpty;
     public IEnumerable<KeyValuePair<string, string>> LoadedDefinitions => _nameToPath.AsEnumerable();
-    public GH_Document Definition(string fileName)
+    public int PoolHits { get; private set; }
+    public int PoolMisses { get; private set; }
+    public TimeSpan WarmUpTime { get; private set; }
+    public GhDefinitionManager()
+    {
+      GhDefinitionStore.Reloaded += OnStoreReloaded;
+    }
+
+    public sealed class PooledDefinition : IDisposable
+    {
+      private GhDefinitionManager _owner;
+      private bool _discard;
+      internal PooledDefinition(GhDefinitionManager owner, string filePath, GH_Archive archive, GH_Document document)
+      {
+        _owner = owner;
+        FilePath = filePath;
+        Archive = archive;
+        Document = document;
+      }
+      internal string FilePath { get; }
+      internal GH_Archive Archive { get; }
+      public GH_Document Document { get; private set; }
+      // the document state was changed in a way a reset does not undo, do not reuse it
+      public void Discard() => _discard = true;
+      public void Dispose()
+      {
+        if (Document == null)
+          return;
+        _owner.Return(this, _discard);
+        Document = null;
+      }
+    }
+    public PooledDefinition Checkout(string fileName)
     {
       var filePath = FindFile(fileName, new string[] { });
       if (string.IsNullOrEmpty(filePath))
         return null;
 
-      if (_docs.TryGetValue(filePath, out var doc))
+      var doc = _acquired.Contains(filePath) ? GhDefinitionStore.Archive(filePath) : null;
+      if (doc == null)
+        return null;
+
+      var pooled = GhDefinitionStore.Pop(filePath, doc);
+      if (pooled != null)
       {
-        var definition = new GH_Document();
-        if (doc.ExtractObject(definition, "Definition"))
-          return definition;
-        definition?.Dispose();
+        ++PoolHits;
+        return new PooledDefinition(this, filePath, doc, pooled);
       }
+
+      ++PoolMisses;
+      var watch = System.Diagnostics.Stopwatch.StartNew();
+      var definition = new GH_Document();
+      bool extracted = doc.ExtractObject(definition, "Definition");
+      WarmUpTime += watch.Elapsed;
+      if (extracted)
+        return new PooledDefinition(this, filePath, doc, definition);
+      definition.Dispose();
       return null;
     }
+    private void Return(PooledDefinition lease, bool discard)
+    {
+      if (discard)
+        lease.Document.Dispose();
+      else
+        GhDefinitionStore.Push(lease.FilePath, lease.Archive, lease.Document);
+    }
+    // reads the file again for every drawing using it
     public void Reload(string defName)
     {
       var filePath = FindFile(defName, new string[] { });
-      if (!string.IsNullOrEmpty(filePath))
-      {
-        var doc = ReadFromFile(filePath);
-        _docs[filePath] = doc;
-        Reloaded?.Invoke(this, defName);
-      }
+      if (string.IsNullOrEmpty(filePath))
+        return;
+
+      Acquire(filePath);
+      GhDefinitionStore.Reload(filePath, true);
     }
     public void Load(string fileName, string[] extraSearchPath)
     {
       var filePath = FindFile(fileName, extraSearchPath);
-      if (string.IsNullOrEmpty(filePath))
+      if (!string.IsNullOrEmpty(filePath))
+        Acquire(filePath);
+    }
+    private void Acquire(string filePath, GH_Archive archive = null, string hash = null)
+    {
+      if (_acquired.Add(filePath))
+        GhDefinitionStore.Acquire(filePath, archive, hash);
+    }
+    private void OnStoreReloaded(object sender, string filePath)
+    {
+      if (!_acquired.Contains(filePath))
         return;
+      foreach (var name in NamesOf(filePath))
+        Reloaded?.Invoke(this, name);
+    }
+    // Resolves and reads the definitions on worker threads. The search path is taken here, on the calling
+    // thread, results are only published by CompletePrefetch, so the dictionaries stay UI thread only.
+    public void Prefetch(IEnumerable<string> fileNames, string[] extraSearchPath)
+    {
+      CompletePrefetch(true);
+      var names = fileNames.Where(name => !string.IsNullOrEmpty(name) && !_nameToPath.ContainsKey(name)).Distinct().ToArray();
+      if (names.Length == 0)
+        return;
+
+      var searchPaths = extraSearchPath.Concat(SearchPaths()).ToArray();
+      _prefetchMissKey = string.Join(";", extraSearchPath);
+      _prefetchSearchPaths = searchPaths;
+      _prefetch = Task.Run(() => names.AsParallel()
+                                      .WithDegreeOfParallelism(Math.Min(names.Length, MaxPrefetchThreads))
+                                      .Select(name => Fetch(name, searchPaths))
+                                      .ToArray());
+      //Idle only fires once the message queue empties again, so an empty message is posted when the
+      //results are ready. The next Idle then sees HasPrefetchResults and queues the regen publishing them
+      var uiContext = System.Threading.SynchronizationContext.Current ?? new System.Windows.Forms.WindowsFormsSynchronizationContext();
+      _prefetch.ContinueWith(task => uiContext.Post(state => { }, null));
+    }
+    // publishes the prefetched definitions, returns false while they are still being read unless waiting
+    public bool CompletePrefetch(bool wait)
+    {
+      if (_prefetch == null)
+        return true;
+      if (!wait && !_prefetch.IsCompleted)
+        return false;
 
-      if (!_docs.ContainsKey(filePath))
+      var prefetch = _prefetch;
+      _prefetch = null;
+      Watch(_prefetchSearchPaths);
+      foreach (var res in prefetch.Result)
       {
-        var doc = ReadFromFile(filePath);
-        if (doc != null)
-          _docs[filePath] = doc;
+        if (string.IsNullOrEmpty(res.FilePath))
+        {
+          _missing.Add(res.Name + "|" + _prefetchMissKey);
+          continue;
+        }
+
+        if (!_nameToPath.ContainsKey(res.Name))
+          _nameToPath[res.Name] = res.FilePath;
+        Acquire(res.FilePath, res.Archive, res.Hash);
       }
+      return true;
     }
-    private static GH_Archive ReadFromFile(string filePath)
+    private static PrefetchResult Fetch(string fileName, string[] searchPaths)
     {
+      var res = new PrefetchResult { Name = fileName };
       try
       {
-        var archive = new GH_Archive();
-        archive.ReadFromFile(filePath);
-        return archive;
+        res.FilePath = FindFile(fileName, searchPaths);
+        //files already opened by another drawing are shared, not read again
+        if (!string.IsNullOrEmpty(res.FilePath) && !GhDefinitionStore.Contains(res.FilePath))
+        {
+          res.Archive = GhDefinitionStore.ReadFromFile(res.FilePath);
+          if (res.Archive != null)
+            res.Hash = GhDefinitionStore.HashFile(res.FilePath);
+        }
       }
       catch (Exception)
       {
-        return null;
+        //malformed search path entries, the file is looked up again when needed
+        res.FilePath = null;
       }
+      return res;
+    }
+    public string DefinitionHash(string fileName)
+    {
+      var filePath = FindFile(fileName, new string[] { });
+      if (string.IsNullOrEmpty(filePath) || !_acquired.Contains(filePath))
+        return null;
+      return GhDefinitionStore.Hash(filePath);
     }
     private string FindFile(string fileName, string[] extraSearchPath)
     {
+      CompletePrefetch(true);
       if (_nameToPath.TryGetValue(fileName, out var keptPath))
         return keptPath;
 
-      foreach (var extPath in extraSearchPath)
+      var searchPaths = extraSearchPath.Concat(SearchPaths()).ToArray();
+      var missKey = fileName + "|" + string.Join(";", extraSearchPath);
+      if (_missing.Contains(missKey))
+        return null;
+
+      var filePath = FindFile(fileName, searchPaths);
+      bool watched = Watch(searchPaths);
+      if (filePath != null)
+        _nameToPath[fileName] = filePath;
+      else if (watched)
+        _missing.Add(missKey);
+      return filePath;
+    }
+    private static string FindFile(string fileName, IEnumerable<string> searchPaths)
+    {
+      foreach (var path in searchPaths)
+      {
+        var filePath = Path.Combine(path, fileName);
+        if (File.Exists(filePath))
+          return filePath;
+      }
+      return null;
+    }
+    private IEnumerable<string> SearchPaths()
+    {
+      var srchPath = _BcAp.Application.GetSystemVariable("SRCHPATH") as string;
+      if (srchPath != _srchPath)
+      {
+        _srchPath = srchPath;
+        _missing.Clear();
+      }
+      return srchPath.Split(';');
+    }
+    #region Search folder watching
+    // returns false if any folder is not watched, lookups failing there can not be cached
+    private bool Watch(IEnumerable<string> folders)
+    {
+      bool allWatched = true;
+      foreach (var folder in folders)
       {
-        string foundPath = Path.Combine(extPath, fileName);
-        if (File.Exists(foundPath))
+        if (string.IsNullOrEmpty(folder))
+          continue;
+        if (_watchers.TryGetValue(folder, out var existing))
         {
-          _nameToPath[fileName] = foundPath;
-          return foundPath;
+          allWatched &= existing != null;
+          continue;
+        }
+        //missing folders are not kept, so they are watched once they are created
+        if (!Directory.Exists(folder))
+        {
+          allWatched = false;
+          continue;
         }
-      }
 
-      var srchPath = _BcAp.Application.GetSystemVariable("SRCHPATH") as string;
-      var paths = srchPath.Split(';');
-      foreach (var path in paths)
+        FileSystemWatcher watcher = null;
+        try
+        {
+          watcher = new FileSystemWatcher(folder, "*.gh*") { NotifyFilter = NotifyFilters.FileName | NotifyFilters.LastWrite };
+          watcher.Created += OnFileChanged;
+          watcher.Deleted += OnFileChanged;
+          watcher.Changed += OnFileChanged;
+          watcher.Renamed += OnFileRenamed;
+          watcher.EnableRaisingEvents = true;
+        }
+        catch (Exception)
+        {
+          //folders that cannot be watched are not tried again
+          watcher?.Dispose();
+          watcher = null;
+        }
+        _watchers[folder] = watcher;
+        allWatched &= watcher != null;
+      }
+      return allWatched;
+    }
+    //the watcher takes a single pattern, which also matches the .ghcache folder and other extensions
+    private static bool IsDefinitionFile(string filePath)
+    {
+      var extension = Path.GetExtension(filePath);
+      return string.Equals(extension, ".gh", StringComparison.OrdinalIgnoreCase) ||
+             string.Equals(extension, ".ghx", StringComparison.OrdinalIgnoreCase);
+    }
+    private void OnFileChanged(object sender, FileSystemEventArgs e)
+    {
+      if (IsDefinitionFile(e.FullPath))
+        _fileChanges.Enqueue(new KeyValuePair<WatcherChangeTypes, string>(e.ChangeType, e.FullPath));
+    }
+    private void OnFileRenamed(object sender, RenamedEventArgs e)
+    {
+      if (IsDefinitionFile(e.OldFullPath))
+        _fileChanges.Enqueue(new KeyValuePair<WatcherChangeTypes, string>(WatcherChangeTypes.Deleted, e.OldFullPath));
+      if (IsDefinitionFile(e.FullPath))
+        _fileChanges.Enqueue(new KeyValuePair<WatcherChangeTypes, string>(WatcherChangeTypes.Created, e.FullPath));
+    }
+    // applies the changes seen by the watchers: new files drop the negative lookups, removed files
+    // their resolved names, and loaded definitions whose content changed are reloaded
+    public void ProcessFileChanges()
+    {
+      var changed = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+      while (_fileChanges.TryDequeue(out var change))
       {
-        var filePath = Path.Combine(path, fileName);
-        if (File.Exists(filePath))
+        switch (change.Key)
         {
-          _nameToPath[fileName] = filePath;
-          return filePath;
+          case WatcherChangeTypes.Created:
+            _missing.Clear();
+            break;
+          case WatcherChangeTypes.Deleted:
+            foreach (var name in NamesOf(change.Value))
+              _nameToPath.Remove(name);
+            break;
+          case WatcherChangeTypes.Changed:
+            changed.Add(change.Value);
+            break;
         }
       }
-      return null;
+
+      //editors raise several notifications per save, the store ignores those leaving the content as is
+      foreach (var filePath in changed)
+      {
+        if (_acquired.Contains(filePath))
+          GhDefinitionStore.Reload(filePath, false);
+      }
+    }
+    private List<string> NamesOf(string filePath) =>
+      _nameToPath.Where(pair => string.Equals(pair.Value, filePath, StringComparison.OrdinalIgnoreCase))
+                 .Select(pair => pair.Key).ToList();
+    #endregion
+    public void Dispose()
+    {
+      GhDefinitionStore.Reloaded -= OnStoreReloaded;
+      foreach (var watcher in _watchers.Values)
+        watcher?.Dispose();
+      _watchers.Clear();
+      foreach (var filePath in _acquired)
+        GhDefinitionStore.Release(filePath);
+      _acquired.Clear();
     }
     public event EventHandler<string> Reloaded;
   }
+  struct GhDataHostInfo
+  {
+    public _OdDb.ObjectId GhDataId;
+    public bool IsVisible;
+  }
   class GhDataManager
   {
     private string DwgPath => Path.GetDirectoryName(Document.Name);
     private Dictionary<_OdDb.ObjectId, CompoundDrawable> _grasshopperData = new Dictionary<_OdDb.ObjectId, CompoundDrawable>();
     private HashSet<_OdDb.ObjectId> _toUpdate = new HashSet<_OdDb.ObjectId>();
+    // order in which the pending updates are processed, on-screen hosts first. Ids updated meanwhile
+    // are skipped, ids queued after it was built are scheduled once it is drained
+    private Queue<_OdDb.ObjectId> _schedule = new Queue<_OdDb.ObjectId>();
+    // time spent per call of Proccess, the rest of the updates waits for the next idle tick
+    public static TimeSpan SliceBudget { get; set; } = TimeSpan.FromMilliseconds(40);
+    // host entity -> GrasshopperData lookup used on every draw, negative results included
+    private Dictionary<_OdDb.ObjectId, GhDataHostInfo> _hostInfo = new Dictionary<_OdDb.ObjectId, GhDataHostInfo>();
+    private Dictionary<_OdDb.ObjectId, _OdDb.ObjectId> _ghDataHost = new Dictionary<_OdDb.ObjectId, _OdDb.ObjectId>();
+    // bumped whenever a host is modified, part of the solution key of definitions reading their host
+    private Dictionary<_OdDb.ObjectId, long> _hostRevision = new Dictionary<_OdDb.ObjectId, long>();
+    private string SolutionCachePath => GhDataSettings.CacheToDisk && Path.IsPathRooted(Document.Name) ?
+                                          Path.Combine(DwgPath, Path.GetFileName(Document.Name) + ".ghcache") : null;
+    public GhSolutionCache Solutions { get; } = new GhSolutionCache();
     public _BcAp.Document Document { get; private set; }
     public GhDefinitionManager DefinitionManager { get; private set; }
     public bool NeedHardUpdate { get; set; }
@@ -126,36 +405,23 @@ namespace GH_BC
           }
         }
       };
-      var database = doc.Database;
+      //only the names are collected here, the definitions are read in the background
+      var definitions = new HashSet<string>();
       using (var transaction = doc.TransactionManager.StartTransaction())
       {
-        using (var blockTable = transaction.GetObject(database.BlockTableId, _OdDb.OpenMode.ForRead) as _OdDb.BlockTable)
+        foreach (var ghDataId in GrasshopperData.GetAllGrasshopperData(doc.Database).Values)
         {
-          var searchPath = new string[] { DwgPath };
-          foreach (var blockId in blockTable)
+          using (var ghData = transaction.GetObject(ghDataId, _OdDb.OpenMode.ForRead) as GrasshopperData)
           {
-            using (var block = transaction.GetObject(blockId, _OdDb.OpenMode.ForRead) as _OdDb.BlockTableRecord)
-            {
-              foreach (var id in block)
-              {
-                using (var entity = transaction.GetObject(id, _OdDb.OpenMode.ForRead) as _OdDb.Entity)
-                {
-                  var ghDataId = GrasshopperData.GetGrasshopperData(entity);
-                  if (ghDataId.IsNull)
-                    continue;
-
-                  using (var ghData = transaction.GetObject(ghDataId, _OdDb.OpenMode.ForRead) as GrasshopperData)
-                  {
-                    DefinitionManager.Load(ghData.Definition, searchPath);
-                    _toUpdate.Add(ghDataId);
-                  }
-                }
-              }
-            }
+            if (ghData == null)
+              continue;
+            definitions.Add(ghData.Definition);
+            _toUpdate.Add(ghDataId);
           }
         }
         transaction.Commit();
       }
+      DefinitionManager.Prefetch(definitions, new string[] { DwgPath });
       EnableReactors();
     }
     public CompoundDrawable GetGhDrawable(_OdDb.ObjectId id)
@@ -164,18 +430,63 @@ namespace GH_BC
         return drawable;
       return null;
     }
+    public GhDataHostInfo GetHostInfo(_OdDb.Entity entity)
+    {
+      var hostId = entity.ObjectId;
+      if (hostId.IsNull)
+        return new GhDataHostInfo();
+      if (_hostInfo.TryGetValue(hostId, out var info))
+        return info;
+
+      info.GhDataId = GrasshopperData.GetGrasshopperData(entity);
+      if (!info.GhDataId.IsNull)
+      {
+        using (var transaction = Document.Database.TransactionManager.StartTransaction())
+        {
+          using (var ghData = transaction.GetObject(info.GhDataId, _OdDb.OpenMode.ForRead) as GrasshopperData)
+          {
+            info.IsVisible = ghData != null && ghData.IsVisible;
+          }
+          transaction.Commit();
+        }
+        _ghDataHost[info.GhDataId] = hostId;
+      }
+      _hostInfo[hostId] = info;
+      return info;
+    }
+    private void InvalidateHost(_OdDb.ObjectId hostId)
+    {
+      if (_hostInfo.TryGetValue(hostId, out var info))
+      {
+        _hostInfo.Remove(hostId);
+        _ghDataHost.Remove(info.GhDataId);
+      }
+    }
+    private void InvalidateGhData(_OdDb.ObjectId ghDataId)
+    {
+      if (_ghDataHost.TryGetValue(ghDataId, out var hostId))
+        InvalidateHost(hostId);
+    }
     public bool HasPendingUpdates()
     {
-      return (NeedHardUpdate || NeedSoftUpdate  || _toUpdate.Count != 0);
+      //nothing can be solved before the definitions are read
+      if (DefinitionManager.IsPrefetching)
+        return false;
+      return (DefinitionManager.HasPrefetchResults || DefinitionManager.HasFileChanges ||
+              NeedHardUpdate || NeedSoftUpdate  || _toUpdate.Count != 0);
     }
     public void Proccess()
     {
+      if (!DefinitionManager.CompletePrefetch(false))
+        return;
+      DefinitionManager.ProcessFileChanges();
       if (NeedHardUpdate)
       {
         NeedHardUpdate = false;
         NeedSoftUpdate = false;
         foreach (var pair in _grasshopperData)
           _toUpdate.Add(pair.Key);
+        _schedule.Clear(); //everything is pending again, order it by the current view
       }
       else if (NeedSoftUpdate)
       {
@@ -203,36 +514,45 @@ namespace GH_BC
       }
       if (_toUpdate.Count == 0)
         return;
+      if (_schedule.Count == 0)
+        BuildSchedule();
+      Solutions.DiskPath = SolutionCachePath;
       DisableReactors();
+      //one definition document per definition and slice, hosts with equal inputs share their cached preview
+      var leases = new Dictionary<string, GhDefinitionManager.PooledDefinition>(StringComparer.OrdinalIgnoreCase);
       try
       {
         var saveDoc = GhDrawingContext.LinkedDocument;
         GhDrawingContext.LinkedDocument = Document; //all bc components use it for computation
         try
         {
+          var watch = System.Diagnostics.Stopwatch.StartNew();
           using (var transaction = Document.TransactionManager.StartTransaction())
           {
-            using (_OdRx.ProgressMeter progress = _OdDb.HostApplicationServices.Current.NewProgressMeter())
+            //at least one host per slice, then until the budget is spent or the user wants the UI back
+            do
             {
-              progress.SetLimit(_toUpdate.Count);
-              progress.Start();
-              foreach (var ghDataId in _toUpdate)
+              var ghDataId = _schedule.Dequeue();
+              if (!_toUpdate.Remove(ghDataId))
+                continue;
+
+              using (var ghData = transaction.GetObject(ghDataId, _OdDb.OpenMode.ForRead) as GrasshopperData)
               {
-                progress.MeterProgress();
-                using (var ghData = transaction.GetObject(ghDataId, _OdDb.OpenMode.ForRead) as GrasshopperData)
-                {
-                  if (ghData == null)
-                    continue;
+                if (ghData == null)
+                  continue;
 
-                  UpdateDrawable(ghData);
-                  using (var hostEnt = transaction.GetObject(ghData.HostEntity, _OdDb.OpenMode.ForWrite) as _OdDb.Entity)
-                  {
-                    hostEnt?.RecordGraphicsModified(true);
-                  }
+                var definition = ghData.Definition ?? string.Empty;
+                if (!leases.TryGetValue(definition, out var lease))
+                  leases[definition] = lease = DefinitionManager.Checkout(definition);
+                if (lease != null)
+                  UpdateDrawable(ghData, lease.Document);
+                using (var hostEnt = transaction.GetObject(ghData.HostEntity, _OdDb.OpenMode.ForWrite) as _OdDb.Entity)
+                {
+                  hostEnt?.RecordGraphicsModified(true);
                 }
               }
-              progress.Stop();
             }
+            while (_schedule.Count != 0 && watch.Elapsed < SliceBudget && !UI.WinAPI.HasPendingInput());
             transaction.Commit();
           }
         }
@@ -243,10 +563,50 @@ namespace GH_BC
       }
       finally
       {
-        _toUpdate.Clear();
+        foreach (var lease in leases.Values)
+          lease?.Dispose();
         EnableReactors();
       }
     }
+    // queues the pending updates, hosts overlapping the current view first
+    private void BuildSchedule()
+    {
+      var visible = new List<_OdDb.ObjectId>();
+      var hidden = new List<_OdDb.ObjectId>();
+      using (var view = Document.Editor.GetCurrentView())
+      {
+        var wcsToDcs = (_OdGe.Matrix3d.Rotation(-view.ViewTwist, view.ViewDirection, view.Target) *
+                        _OdGe.Matrix3d.Displacement(view.Target - _OdGe.Point3d.Origin) *
+                        _OdGe.Matrix3d.PlaneToWorld(view.ViewDirection)).Inverse();
+        var viewMin = new _OdGe.Point2d(view.CenterPoint.X - view.Width / 2.0, view.CenterPoint.Y - view.Height / 2.0);
+        var viewMax = new _OdGe.Point2d(view.CenterPoint.X + view.Width / 2.0, view.CenterPoint.Y + view.Height / 2.0);
+        using (var transaction = Document.TransactionManager.StartTransaction())
+        {
+          foreach (var ghDataId in _toUpdate)
+          {
+            bool isVisible = false;
+            using (var ghData = transaction.GetObject(ghDataId, _OdDb.OpenMode.ForRead) as GrasshopperData)
+            {
+              if (ghData != null && transaction.GetObject(ghData.HostEntity, _OdDb.OpenMode.ForRead) is _OdDb.Entity hostEnt)
+              {
+                var bounds = hostEnt.Bounds;
+                if (bounds.HasValue)
+                {
+                  var extents = bounds.Value;
+                  extents.TransformBy(wcsToDcs);
+                  isVisible = extents.MinPoint.X <= viewMax.X && extents.MaxPoint.X >= viewMin.X &&
+                              extents.MinPoint.Y <= viewMax.Y && extents.MaxPoint.Y >= viewMin.Y;
+                }
+              }
+            }
+            (isVisible ? visible : hidden).Add(ghDataId);
+          }
+          transaction.Commit();
+        }
+      }
+      visible.ForEach(_schedule.Enqueue);
+      hidden.ForEach(_schedule.Enqueue);
+    }
     public bool AddGrasshopperData(GrasshopperData grasshopperData)
     {
       var objId = grasshopperData.ObjectId;
@@ -254,12 +614,12 @@ namespace GH_BC
         return false;
 
       DefinitionManager.Load(grasshopperData.Definition, new string[] { DwgPath });
-      using (var definition = DefinitionManager.Definition(grasshopperData.Definition))
+      using (var lease = DefinitionManager.Checkout(grasshopperData.Definition))
       {
-        if (definition == null)
+        if (lease == null)
           return false;
 
-        foreach (var param in GrasshopperPlayer.GetInputParametersValues(definition))
+        foreach (var param in GrasshopperPlayer.GetInputParametersValues(lease.Document))
         {
           if (param.Item2 is Type type)
             grasshopperData.AddProperty(param.Item1, type);
@@ -271,12 +631,15 @@ namespace GH_BC
     }
     public void Bake(List<_OdDb.ObjectId> ghDataIds, UI.BakeDialog bakeProperties)
     {
+      //everything baked for all hosts is undone at once
+      Document.Database.StartUndoRecord();
       DisableReactors();
       var saveDoc = GhDrawingContext.LinkedDocument;
       GhDrawingContext.LinkedDocument = Document;
       try
       {
-        using (var transaction = Document.TransactionManager.StartTransaction())
+        //not a transaction of the manager, so the bake components append their entities in top-level transactions
+        using (var transaction = Document.TransactionManager.StartOpenCloseTransaction())
         {
           using (_OdRx.ProgressMeter progress = _OdDb.HostApplicationServices.Current.NewProgressMeter())
           {
@@ -290,11 +653,14 @@ namespace GH_BC
                 if (ghData == null)
                   continue;
 
-                using (var definition = DefinitionManager.Definition(ghData.Definition))
+                using (var lease = DefinitionManager.Checkout(ghData.Definition))
                 {
-                  if (definition == null)
+                  if (lease == null)
                     continue;
             
+                  //bake components keep their bake request, so the document is not reused
+                  lease.Discard();
+                  var definition = lease.Document;
                   foreach (var obj in definition.Objects.OfType<Components.BakeComponent>())
                   {
                     if (!obj.Locked)
@@ -315,26 +681,50 @@ namespace GH_BC
         EnableReactors();
       }
     }
-    private void UpdateDrawable(GrasshopperData grasshopperData)
+    private void UpdateDrawable(GrasshopperData grasshopperData, GH_Document definition)
     {
       if (!grasshopperData.IsVisible)
         return;
 
-      using (var definition = DefinitionManager.Definition(grasshopperData.Definition))
+      GrasshopperPlayer.ResetInputs(definition);
+      //without a hash of the file, solutions of different definitions could not be told apart
+      var definitionHash = DefinitionManager.DefinitionHash(grasshopperData.Definition);
+      var inputKey = GrasshopperPlayer.GetInputKey(definition, grasshopperData, out bool usesHost);
+      string solutionKey = null;
+      if (definitionHash != null)
       {
-        if (definition == null)
-          return;
+        solutionKey = definitionHash + "|" + inputKey;
+        //host revisions are per session, so those solutions are not persisted
+        if (usesHost)
+        {
+          _hostRevision.TryGetValue(grasshopperData.HostEntity, out long revision);
+          solutionKey += "|" + revision;
+        }
+      }
 
+      var solution = solutionKey != null ? Solutions.Find(solutionKey, !usesHost) : null;
+      if (solution == null)
+      {
         GrasshopperPlayer.Run(definition, grasshopperData, Document);
-        var newDrawable = new CompoundDrawable
-        {
-          Color = GhDataSettings.Color,
-          ColorSelected = GhDataSettings.Color,
-          IsRenderMode = GhDataSettings.VisualStyle == GH_PreviewMode.Shaded
-        };
-        GrasshopperPreview.GetPreview(definition, newDrawable);
-        _grasshopperData[grasshopperData.ObjectId] = newDrawable;
+        solution = new CompoundDrawable();
+        GrasshopperPreview.GetPreview(definition, solution);
+        if (solutionKey != null)
+          Solutions.Add(solutionKey, solution, !usesHost);
       }
+      //cached solutions are shared between hosts, the display state belongs to each host
+      var drawable = new CompoundDrawable(solution)
+      {
+        Color = GhDataSettings.Color,
+        ColorSelected = GhDataSettings.Color,
+        IsRenderMode = GhDataSettings.VisualStyle == GH_PreviewMode.Shaded,
+        Database = Document.Database
+      };
+      _grasshopperData[grasshopperData.ObjectId] = drawable;
+    }
+    private void BumpHostRevision(_OdDb.ObjectId hostId)
+    {
+      _hostRevision.TryGetValue(hostId, out long revision);
+      _hostRevision[hostId] = revision + 1;
     }
     #region DbObjects reactors
     private void EnableReactors()
@@ -351,12 +741,24 @@ namespace GH_BC
     {
       var objId = e.DBObject.ObjectId;
       if (objId.ObjectClass.IsDerivedFrom(_OdRx.RXObject.GetClass(typeof(GrasshopperData))))
+      {
+        InvalidateGhData(objId);
         _toUpdate.Add(objId);
+      }
       else if (e.DBObject is _OdDb.Entity ent)
       {
+        InvalidateHost(objId);
         var id = GrasshopperData.GetGrasshopperData(ent);
         if (!id.IsNull)
+        {
+          BumpHostRevision(objId);
           _toUpdate.Add(id);
+        }
+      }
+      else if (e.DBObject is _OdDb.DBDictionary dict)
+      {
+        //GrasshopperData attached to or removed from an existing extension dictionary
+        InvalidateHost(dict.OwnerId);
       }
       else if (e.DBObject is _OdDb.BlockTableRecord btr)
       {
@@ -368,7 +770,10 @@ namespace GH_BC
             {
               var id = GrasshopperData.GetGrasshopperData(blockRef);
               if (!id.IsNull)
+              {
+                BumpHostRevision(refId);
                 _toUpdate.Add(id);
+              }
             }
           }
         }
@@ -379,9 +784,15 @@ namespace GH_BC
       var obj = e.DBObject;
       var ghId = _OdDb.ObjectId.Null;
       if (obj is GrasshopperData)
+      {
         ghId = obj.ObjectId;
+        InvalidateGhData(ghId);
+      }
       else if(obj is _OdDb.Entity ent)
+      {
+        InvalidateHost(obj.ObjectId);
         ghId = GrasshopperData.GetGrasshopperData(ent);
+      }
 
       if(!ghId.IsNull)
       {
@@ -420,11 +831,41 @@ namespace GH_BC
         }
       }
     }
-    public static short HostTransparency => System.Convert.ToInt16(255 - (short) _BcAp.Application.GetSystemVariable("GhHostTransparency") * 2.55);
+    // degree of parallelism of the preview meshing, 0 uses all cores
+    public static int MeshThreads
+    {
+      get
+      {
+        int val = System.Convert.ToInt32(_BcAp.Application.GetSystemVariable("GhMeshThreads"));
+        return val > 0 ? val : Environment.ProcessorCount;
+      }
+    }
+    public static bool CacheToDisk => System.Convert.ToInt32(_BcAp.Application.GetSystemVariable("GhCacheToDisk")) != 0;
+    // entities appended per transaction when baking, 0 appends everything in a single transaction
+    public static int BakeChunkSize => System.Convert.ToInt32(_BcAp.Application.GetSystemVariable("GhBakeChunkSize"));
+    // read on every host draw, so kept until the variable changes or another drawing becomes current
+    private static short? _hostTransparency;
+    private static _BcAp.Document _hostTransparencyDoc;
+    public static short HostTransparency
+    {
+      get
+      {
+        var doc = _BcAp.Application.DocumentManager.MdiActiveDocument;
+        if (!_hostTransparency.HasValue || _hostTransparencyDoc != doc)
+        {
+          _hostTransparency = System.Convert.ToInt16(255 - (short) _BcAp.Application.GetSystemVariable("GhHostTransparency") * 2.55);
+          _hostTransparencyDoc = doc;
+        }
+        return _hostTransparency.Value;
+      }
+    }
     public override bool Set(string VarName, object VarValue) 
     {
       Changed?.Invoke(this, VarName);
-      return base.Set(VarName, VarValue);
+      var res = base.Set(VarName, VarValue);
+      if (VarName == "GhHostTransparency")
+        _hostTransparency = null;
+      return res;
     }
     public static System.Drawing.Color Color
     {
@@ -469,6 +910,7 @@ namespace GH_BC
   class GhDataExtension
   {
     private Dictionary<_BcAp.Document, GhDataManager> _ghManMap = new Dictionary<_BcAp.Document, GhDataManager>();
+    private Dictionary<_OdDb.Database, GhDataManager> _dbManMap = new Dictionary<_OdDb.Database, GhDataManager>();
     private GhDataSettings _ghSettings = new GhDataSettings();
     private GhDataOverrule _overrule = new GhDataOverrule();
     public GhDataExtension() {}
@@ -498,6 +940,11 @@ namespace GH_BC
     }
     public GhDataManager GrasshopperDataManager(_OdDb.Database database, bool createIfNotExist = false)
     {
+      if (database == null)
+        return null;
+      if (_dbManMap.TryGetValue(database, out var ghMan))
+        return ghMan;
+
       var bcDoc = DatabaseUtils.FindDocument(database);
       return GrasshopperDataManager(bcDoc, createIfNotExist);
     }
@@ -514,6 +961,7 @@ namespace GH_BC
 
       ghMan = new GhDataManager(doc);
       _ghManMap[doc] = ghMan;
+      _dbManMap[doc.Database] = ghMan;
       return ghMan;
     }
     public void Update(GhDataManager docExt)
@@ -540,11 +988,21 @@ namespace GH_BC
     #region BcDoc reactors
     private void OnBcDocDestroyed(object sender, _BcAp.DocumentCollectionEventArgs e)
     {
+      BlockGeometryCache.Clear(e.Document.Database);
+      Types.ReferenceGeometryCache.Clear(e.Document.Database);
+      DatabaseUtils.ReleaseVisualStyles(e.Document.Database);
+      if (_ghManMap.TryGetValue(e.Document, out var ghMan))
+      {
+        _dbManMap.Remove(ghMan.Document.Database);
+        ghMan.DefinitionManager.Dispose();
+      }
       _ghManMap.Remove(e.Document);
     }
     private void OnBcDocCreated(object sender, _BcAp.DocumentCollectionEventArgs e)
     {
-      _ghManMap[e.Document] = new GhDataManager(e.Document);
+      var ghMan = new GhDataManager(e.Document);
+      _ghManMap[e.Document] = ghMan;
+      _dbManMap[e.Document.Database] = ghMan;
     }
     #endregion
     #region Overrule registration
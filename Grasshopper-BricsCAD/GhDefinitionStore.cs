@@ -0,0 +1,170 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using GH_IO.Serialization;
+using Grasshopper.Kernel;
+
+namespace GH_BC
+{
+  // Definition archives shared by all open drawings, keyed by absolute path. Each GhDefinitionManager
+  // holds a reference on the files it uses, an archive is dropped with its last reference.
+  // Runs are sequential on the UI thread, so the ready to run documents are pooled here as well.
+  // Entries are only read and changed under the lock, files are read outside of it.
+  static class GhDefinitionStore
+  {
+    private const int MaxPooledDefinitions = 4;
+    private class Entry
+    {
+      public GH_Archive Archive;
+      public string Hash;
+      public int RefCount;
+      public Stack<GH_Document> Pool = new Stack<GH_Document>();
+    }
+    private static readonly object _lock = new object();
+    private static Dictionary<string, Entry> _entries = new Dictionary<string, Entry>(StringComparer.OrdinalIgnoreCase);
+    public static int Count
+    {
+      get { lock (_lock) return _entries.Count; }
+    }
+    // raised with the path of a reloaded file, every drawing using it refreshes its hosts
+    public static event EventHandler<string> Reloaded;
+
+    public static bool Contains(string filePath)
+    {
+      lock (_lock)
+        return _entries.ContainsKey(filePath);
+    }
+    // takes a reference on the file, an archive already read (e.g. prefetched) is used when the file is new
+    public static void Acquire(string filePath, GH_Archive archive = null, string hash = null)
+    {
+      lock (_lock)
+      {
+        if (_entries.TryGetValue(filePath, out var entry))
+        {
+          ++entry.RefCount;
+          return;
+        }
+      }
+
+      if (archive == null)
+      {
+        archive = ReadFromFile(filePath);
+        hash = archive != null ? HashFile(filePath) : null;
+      }
+      lock (_lock)
+      {
+        //another caller may have added the file while it was read here
+        if (_entries.TryGetValue(filePath, out var entry))
+          ++entry.RefCount;
+        else
+          _entries.Add(filePath, new Entry { Archive = archive, Hash = hash, RefCount = 1 });
+      }
+    }
+    public static void Release(string filePath)
+    {
+      Entry entry;
+      lock (_lock)
+      {
+        if (!_entries.TryGetValue(filePath, out entry) || --entry.RefCount > 0)
+          return;
+        _entries.Remove(filePath);
+      }
+      ClearPool(entry.Pool);
+    }
+    public static GH_Archive Archive(string filePath)
+    {
+      lock (_lock)
+        return _entries.TryGetValue(filePath, out var entry) ? entry.Archive : null;
+    }
+    public static string Hash(string filePath)
+    {
+      lock (_lock)
+        return _entries.TryGetValue(filePath, out var entry) ? entry.Hash : null;
+    }
+    // reads the file again, unless forced only when its content changed
+    public static void Reload(string filePath, bool force)
+    {
+      lock (_lock)
+      {
+        if (!_entries.ContainsKey(filePath))
+          return;
+      }
+
+      var hash = HashFile(filePath);
+      if (!force && hash != null && hash == Hash(filePath))
+        return;
+
+      //the file is read outside the lock, the entry is only swapped under it
+      var archive = ReadFromFile(filePath);
+      Stack<GH_Document> oldPool;
+      lock (_lock)
+      {
+        if (!_entries.TryGetValue(filePath, out var entry))
+          return;
+        entry.Archive = archive;
+        entry.Hash = hash;
+        oldPool = entry.Pool;
+        entry.Pool = new Stack<GH_Document>();
+      }
+      ClearPool(oldPool);
+      Reloaded?.Invoke(null, filePath);
+    }
+    public static GH_Document Pop(string filePath, GH_Archive archive)
+    {
+      lock (_lock)
+      {
+        if (_entries.TryGetValue(filePath, out var entry) && entry.Archive == archive && entry.Pool.Count != 0)
+          return entry.Pool.Pop();
+      }
+      return null;
+    }
+    // documents extracted from an archive that has been reloaded or released meanwhile are dropped
+    public static void Push(string filePath, GH_Archive archive, GH_Document definition)
+    {
+      lock (_lock)
+      {
+        if (_entries.TryGetValue(filePath, out var entry) && entry.Archive == archive &&
+            entry.Pool.Count < MaxPooledDefinitions)
+        {
+          GrasshopperPlayer.ResetInputs(definition);
+          entry.Pool.Push(definition);
+          return;
+        }
+      }
+      definition.Dispose();
+    }
+    // only called on pools no longer reachable through _entries
+    private static void ClearPool(Stack<GH_Document> pool)
+    {
+      foreach (var definition in pool)
+        definition.Dispose();
+      pool.Clear();
+    }
+    public static string HashFile(string filePath)
+    {
+      try
+      {
+        using (var sha = System.Security.Cryptography.SHA1.Create())
+        using (var stream = File.OpenRead(filePath))
+          return System.Convert.ToBase64String(sha.ComputeHash(stream));
+      }
+      catch (Exception)
+      {
+        return null;
+      }
+    }
+    public static GH_Archive ReadFromFile(string filePath)
+    {
+      try
+      {
+        var archive = new GH_Archive();
+        archive.ReadFromFile(filePath);
+        return archive;
+      }
+      catch (Exception)
+      {
+        return null;
+      }
+    }
+  }
+}
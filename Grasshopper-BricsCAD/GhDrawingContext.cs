@@ -9,10 +9,52 @@ namespace GH_BC
 {
   static class GhDrawingContext
   {
-    static private List<_OdDb.Handle> _modified = new List<_OdDb.Handle>();
-    static private List<_OdDb.Handle> _erased = new List<_OdDb.Handle>();
-    static private List<_OdDb.Handle> _appended = new List<_OdDb.Handle>();
-    static private List<string> _commands = new List<string>();
+    // reverse indices of a definition: referenced handle -> params subscribed to it, one per change stream
+    // (volatile references for modified and erased handles, persistent ones for appended handles),
+    // rebuilt after the solutions and edits that may change the references
+    private class HandleIndex
+    {
+      public Dictionary<_OdDb.Handle, List<Parameters.IGH_BcHandleSubscriber>> OnChange =
+        new Dictionary<_OdDb.Handle, List<Parameters.IGH_BcHandleSubscriber>>();
+      public Dictionary<_OdDb.Handle, List<Parameters.IGH_BcHandleSubscriber>> OnAppend =
+        new Dictionary<_OdDb.Handle, List<Parameters.IGH_BcHandleSubscriber>>();
+      public List<Grasshopper.Kernel.IGH_ActiveObject> Others = new List<Grasshopper.Kernel.IGH_ActiveObject>();
+      public bool Dirty = true;
+      public void SetDirty(object sender, EventArgs e) => Dirty = true;
+      public void Build(Grasshopper.Kernel.GH_Document definition)
+      {
+        OnChange.Clear();
+        OnAppend.Clear();
+        Others.Clear();
+        foreach (var obj in definition.Objects)
+        {
+          if (obj is Parameters.IGH_BcHandleSubscriber subscriber)
+          {
+            Subscribe(OnChange, subscriber.VolatileHandles, subscriber);
+            Subscribe(OnAppend, subscriber.PersistentHandles, subscriber);
+          }
+          else if (obj is Parameters.IGH_BcParam || obj is Components.IGH_BcComponent)
+            Others.Add((Grasshopper.Kernel.IGH_ActiveObject) obj);
+        }
+        Dirty = false;
+      }
+      private static void Subscribe(Dictionary<_OdDb.Handle, List<Parameters.IGH_BcHandleSubscriber>> index,
+                                    IEnumerable<_OdDb.Handle> handles, Parameters.IGH_BcHandleSubscriber subscriber)
+      {
+        foreach (var handle in handles)
+        {
+          if (!index.TryGetValue(handle, out var subscribers))
+            index.Add(handle, subscribers = new List<Parameters.IGH_BcHandleSubscriber>());
+          if (subscribers.Count == 0 || subscribers[subscribers.Count - 1] != subscriber)
+            subscribers.Add(subscriber);
+        }
+      }
+    }
+    static private HashSet<_OdDb.Handle> _modified = new HashSet<_OdDb.Handle>();
+    static private HashSet<_OdDb.Handle> _erased = new HashSet<_OdDb.Handle>();
+    static private HashSet<_OdDb.Handle> _appended = new HashSet<_OdDb.Handle>();
+    static private HashSet<string> _commands = new HashSet<string>();
+    static private Dictionary<Grasshopper.Kernel.GH_Document, HandleIndex> _indices = new Dictionary<Grasshopper.Kernel.GH_Document, HandleIndex>();
     static private Visualization.GrasshopperPreview _preview = null;
     static readonly HashSet<string> _commandToExpire = new HashSet<string>() { "BIMSPATIALLOCATIONS" };
     static public _BcAp.Document LinkedDocument { get; set; }
@@ -55,6 +97,7 @@ namespace GH_BC
         LinkedDocument.CloseWillStart -= OnBcDocCloseWillStart;
       }
       _preview?.Dispose();
+      Types.ReferenceGeometryCache.Clear();
       LinkedDocument = document;
       LinkedDocument.CloseWillStart += OnBcDocCloseWillStart;
       LinkedDocument.Database.ObjectModified += OnObjectModified;
@@ -105,6 +148,7 @@ namespace GH_BC
       _preview?.Dispose();
       _preview = null;
       LinkedDocument = null;
+      Types.ReferenceGeometryCache.Clear();
       Rhinoceros.Script.HideEditor();
       ExpireGH();
     }
@@ -112,26 +156,50 @@ namespace GH_BC
     static private void OnDocumentChanged()
     {
       if (_commands.Count != 0)
-        _commands = _commands.Intersect(_commandToExpire).ToList();
+        _commands.IntersectWith(_commandToExpire);
 
       if (_erased.Count == 0 && _modified.Count == 0 && _appended.Count == 0 && _commands.Count == 0)
         return;
 
-      foreach (Grasshopper.Kernel.GH_Document definition in Grasshopper.Instances.DocumentServer)
+      var definitions = new HashSet<Grasshopper.Kernel.GH_Document>(Grasshopper.Instances.DocumentServer);
+      foreach (var closed in _indices.Keys.Where(definition => !definitions.Contains(definition)).ToList())
+        ReleaseIndex(closed);
+
+      foreach (var definition in definitions)
       {
         bool expireNow = Grasshopper.Kernel.GH_Document.EnableSolutions &&
                          Grasshopper.Instances.ActiveCanvas.Document == definition &&
                          definition.Enabled &&
                          definition.SolutionState != Grasshopper.Kernel.GH_ProcessStep.Process;
         bool objExpired = false;
-        foreach (var obj in definition.Objects)
+        var index = GetIndex(definition);
+
+        //only the params referencing a changed handle are visited
+        var expired = new HashSet<Parameters.IGH_BcHandleSubscriber>();
+        foreach (var handle in _modified.Concat(_erased))
         {
-          if (obj is Parameters.IGH_BcParam persistentParam)
+          if (index.OnChange.TryGetValue(handle, out var subscribers))
+            expired.UnionWith(subscribers);
+        }
+        foreach (var handle in _appended)
+        {
+          if (index.OnAppend.TryGetValue(handle, out var subscribers))
+            expired.UnionWith(subscribers);
+        }
+        foreach (var persistentParam in expired)
+        {
+          if (IsExpirable(persistentParam))
           {
-            if (persistentParam.DataType == Grasshopper.Kernel.GH_ParamData.remote)
-              continue;
+            persistentParam.ExpireSolution(false);
+            objExpired = true;
+          }
+        }
 
-            if (persistentParam.Phase == Grasshopper.Kernel.GH_SolutionPhase.Blank)
+        foreach (var obj in index.Others)
+        {
+          if (obj is Parameters.IGH_BcParam persistentParam)
+          {
+            if (!IsExpirable(persistentParam))
               continue;
 
             if (persistentParam.NeedsToBeExpired(_modified, _erased, _appended, _commands))
@@ -158,6 +226,31 @@ namespace GH_BC
       _appended.Clear();
       _commands.Clear();
     }
+    static private bool IsExpirable(Parameters.IGH_BcParam param) =>
+      param.DataType != Grasshopper.Kernel.GH_ParamData.remote &&
+      param.Phase != Grasshopper.Kernel.GH_SolutionPhase.Blank;
+    static private HandleIndex GetIndex(Grasshopper.Kernel.GH_Document definition)
+    {
+      if (!_indices.TryGetValue(definition, out var index))
+      {
+        index = new HandleIndex();
+        definition.SolutionEnd += index.SetDirty;
+        definition.ObjectsAdded += index.SetDirty;
+        definition.ObjectsDeleted += index.SetDirty;
+        _indices.Add(definition, index);
+      }
+      if (index.Dirty)
+        index.Build(definition);
+      return index;
+    }
+    static private void ReleaseIndex(Grasshopper.Kernel.GH_Document definition)
+    {
+      var index = _indices[definition];
+      definition.SolutionEnd -= index.SetDirty;
+      definition.ObjectsAdded -= index.SetDirty;
+      definition.ObjectsDeleted -= index.SetDirty;
+      _indices.Remove(definition);
+    }
     static private void ExpireGH()
     {
       foreach (Grasshopper.Kernel.GH_Document definition in Grasshopper.Instances.DocumentServer)
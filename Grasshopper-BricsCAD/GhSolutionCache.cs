@@ -0,0 +1,234 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Security.Cryptography;
+using System.Text;
+using Rhino.FileIO;
+using GH_BC.Visualization;
+
+namespace GH_BC
+{
+  // Previews of solved definitions keyed by their content (definition hash, input values and,
+  // for definitions reading the host, its revision). Entries are shared by all hosts with the same key,
+  // the least recently used ones are dropped once MaxBytes is exceeded. The on-disk store is pruned
+  // the same way against MaxDiskBytes, by file time, which is refreshed whenever an entry is read.
+  class GhSolutionCache
+  {
+    private const long BlockRefBytes = 512;
+    private class Entry
+    {
+      public string Key;
+      public CompoundDrawable Drawable;
+      public long Bytes;
+    }
+    private Dictionary<string, LinkedListNode<Entry>> _entries = new Dictionary<string, LinkedListNode<Entry>>();
+    private LinkedList<Entry> _lru = new LinkedList<Entry>();
+    public long MaxBytes { get; set; } = 256L * 1024 * 1024;
+    private string _diskPath;
+    private long _diskBytes = -1;
+    // folder of the on-disk store, null when solutions are only kept in memory
+    public string DiskPath
+    {
+      get => _diskPath;
+      set
+      {
+        if (_diskPath != value)
+          _diskBytes = -1;
+        _diskPath = value;
+      }
+    }
+    public long MaxDiskBytes { get; set; } = 512L * 1024 * 1024;
+    public int Hits { get; private set; }
+    public int DiskHits { get; private set; }
+    public int Misses { get; private set; }
+    public long BytesHeld { get; private set; }
+    public int Count => _entries.Count;
+    public double HitRate => Hits + Misses == 0 ? 0.0 : (double) Hits / (Hits + Misses);
+    public int DiskCount => DiskEntries().Count();
+    public long DiskBytes
+    {
+      get
+      {
+        if (_diskBytes < 0)
+          _diskBytes = DiskEntries().Sum(file => file.Length);
+        return _diskBytes;
+      }
+    }
+
+    public CompoundDrawable Find(string key, bool persistent)
+    {
+      if (_entries.TryGetValue(key, out var node))
+      {
+        _lru.Remove(node);
+        _lru.AddFirst(node);
+        ++Hits;
+        return node.Value.Drawable;
+      }
+
+      if (persistent && Load(key) is CompoundDrawable drawable)
+      {
+        ++Hits;
+        ++DiskHits;
+        AddEntry(key, drawable);
+        return drawable;
+      }
+      ++Misses;
+      return null;
+    }
+    public void Add(string key, CompoundDrawable drawable, bool persistent)
+    {
+      AddEntry(key, drawable);
+      if (persistent)
+        Store(key, drawable);
+    }
+    public void Clear()
+    {
+      _entries.Clear();
+      _lru.Clear();
+      BytesHeld = 0;
+    }
+    private void AddEntry(string key, CompoundDrawable drawable)
+    {
+      if (_entries.TryGetValue(key, out var node))
+      {
+        BytesHeld -= node.Value.Bytes;
+        _lru.Remove(node);
+      }
+
+      var entry = new Entry { Key = key, Drawable = drawable, Bytes = EstimateBytes(drawable) };
+      _entries[key] = _lru.AddFirst(entry);
+      BytesHeld += entry.Bytes;
+      while (BytesHeld > MaxBytes && _lru.Count > 1)
+      {
+        var last = _lru.Last;
+        _lru.RemoveLast();
+        _entries.Remove(last.Value.Key);
+        BytesHeld -= last.Value.Bytes;
+      }
+    }
+    private static long EstimateBytes(CompoundDrawable drawable)
+    {
+      long bytes = drawable.BlockRefCount * BlockRefBytes;
+      foreach (var geometry in drawable.Geometry(false).Concat(drawable.Geometry(true)))
+        bytes += geometry.MemoryEstimate();
+      return bytes;
+    }
+    #region On-disk store
+    private string EntryPath(string key)
+    {
+      using (var sha = SHA1.Create())
+      {
+        var hash = sha.ComputeHash(Encoding.UTF8.GetBytes(key));
+        var name = BitConverter.ToString(hash).Replace("-", string.Empty);
+        return Path.Combine(DiskPath, name + ".3dm");
+      }
+    }
+    private CompoundDrawable Load(string key)
+    {
+      if (string.IsNullOrEmpty(DiskPath))
+        return null;
+
+      var path = EntryPath(key);
+      if (!File.Exists(path))
+        return null;
+
+      try
+      {
+        File.SetLastWriteTimeUtc(path, DateTime.UtcNow);
+        using (var file = File3dm.Read(path))
+        {
+          if (file == null)
+            return null;
+
+          var drawable = new CompoundDrawable();
+          foreach (var obj in file.Objects)
+            drawable.AddDrawable(new PreviewDrawable(obj.Geometry.Duplicate()), obj.Attributes.Name == "selected");
+          return drawable;
+        }
+      }
+      catch (Exception)
+      {
+        return null;
+      }
+    }
+    private void Store(string key, CompoundDrawable drawable)
+    {
+      // block references point into the drawing, those previews are only kept in memory
+      if (string.IsNullOrEmpty(DiskPath) || drawable.BlockRefCount != 0)
+        return;
+
+      try
+      {
+        Directory.CreateDirectory(DiskPath);
+        var path = EntryPath(key);
+        var diskBytes = DiskBytes;
+        if (File.Exists(path))
+          diskBytes -= new FileInfo(path).Length;
+        using (var file = new File3dm())
+        {
+          AddObjects(file, drawable.Geometry(false), null);
+          AddObjects(file, drawable.Geometry(true), "selected");
+          file.Write(path, new File3dmWriteOptions());
+        }
+        _diskBytes = diskBytes + new FileInfo(path).Length;
+        if (_diskBytes > MaxDiskBytes)
+          PruneDisk(path);
+      }
+      catch (Exception)
+      {
+        // the on-disk store is an optimization only
+        _diskBytes = -1;
+      }
+    }
+    private IEnumerable<FileInfo> DiskEntries()
+    {
+      if (string.IsNullOrEmpty(DiskPath) || !Directory.Exists(DiskPath))
+        return Enumerable.Empty<FileInfo>();
+      return new DirectoryInfo(DiskPath).EnumerateFiles("*.3dm");
+    }
+    // deletes the least recently used files until the store fits MaxDiskBytes again, keeping the one just written
+    private void PruneDisk(string keepPath)
+    {
+      keepPath = Path.GetFullPath(keepPath);
+      foreach (var file in DiskEntries().OrderBy(file => file.LastWriteTimeUtc).ToList())
+      {
+        if (_diskBytes <= MaxDiskBytes)
+          break;
+        if (string.Equals(file.FullName, keepPath, StringComparison.OrdinalIgnoreCase))
+          continue;
+
+        try
+        {
+          var bytes = file.Length;
+          file.Delete();
+          _diskBytes -= bytes;
+        }
+        catch (IOException)
+        {
+          // still read by another drawing sharing the folder
+        }
+      }
+    }
+    private static void AddObjects(File3dm file, IEnumerable<Rhino.Geometry.GeometryBase> geometries, string name)
+    {
+      var attributes = new Rhino.DocObjects.ObjectAttributes { Name = name };
+      foreach (var geometry in geometries)
+      {
+        switch (geometry)
+        {
+          case Rhino.Geometry.Mesh mesh:
+            file.Objects.AddMesh(mesh, attributes);
+            break;
+          case Rhino.Geometry.Curve curve:
+            file.Objects.AddCurve(curve, attributes);
+            break;
+          case Rhino.Geometry.Point point:
+            file.Objects.AddPoint(point.Location, attributes);
+            break;
+        }
+      }
+    }
+    #endregion
+  }
+}
@@ -1,5 +1,8 @@
 using System;
 using System.Collections.Generic;
+using System.Globalization;
+using System.Linq;
+using System.Text;
 using Grasshopper.Kernel;
 using Grasshopper.Kernel.Parameters;
 using _BcAp = Bricscad.ApplicationServices;
@@ -19,6 +22,7 @@ namespace GH_BC
       var hostEntityId = ghData.HostEntity;
       try
       {
+        var propInputs = new List<IGH_Param>(inputs.Count);
         foreach (var input in inputs)
         {
           if (!IsInputName(input.NickName))
@@ -32,8 +36,14 @@ namespace GH_BC
             data.LoadGeometry(bcDoc);
             continue;
           }
+          propInputs.Add(input);
+        }
 
-          var prop = ghData.GetProperty(FormatName(input.NickName));
+        var props = ghData.GetProperties(propInputs.Select(param => FormatName(param.NickName)).ToArray());
+        for (int i = 0; i < propInputs.Count; ++i)
+        {
+          var input = propInputs[i];
+          var prop = props[i];
           if (prop == null)
             continue;
 
@@ -144,6 +154,64 @@ namespace GH_BC
 
       return inputs;
     }
+    // identifies the values Run feeds into the definition, runs with equal keys give equal results
+    public static string GetInputKey(GH_Document definition, GrasshopperData ghData, out bool usesHost)
+    {
+      usesHost = false;
+      var key = new StringBuilder();
+      var propNames = new List<string>();
+      foreach (var input in GetInputParams(definition))
+      {
+        //the host geometry is an input, so the result is specific to this host
+        if (input is Parameters.BcEntity)
+        {
+          usesHost = true;
+          key.Append('#').Append(ghData.HostEntity.Handle.Value).Append(';');
+        }
+        else
+          propNames.Add(FormatName(input.NickName));
+      }
+
+      var props = ghData.GetProperties(propNames.ToArray());
+      for (int i = 0; i < propNames.Count; ++i)
+      {
+        key.Append(propNames[i]).Append('=');
+        switch (props[i])
+        {
+          case double doubleValue:
+            key.Append(doubleValue.ToString("R", CultureInfo.InvariantCulture));
+            break;
+          case string strValue:
+            key.Append(strValue.Length).Append(':').Append(strValue);
+            break;
+          case _OdGe.Point3d pntValue:
+            key.Append(pntValue.X.ToString("R", CultureInfo.InvariantCulture)).Append(',')
+               .Append(pntValue.Y.ToString("R", CultureInfo.InvariantCulture)).Append(',')
+               .Append(pntValue.Z.ToString("R", CultureInfo.InvariantCulture));
+            break;
+          case _OdGe.Vector3d vecValue:
+            key.Append(vecValue.X.ToString("R", CultureInfo.InvariantCulture)).Append(',')
+               .Append(vecValue.Y.ToString("R", CultureInfo.InvariantCulture)).Append(',')
+               .Append(vecValue.Z.ToString("R", CultureInfo.InvariantCulture));
+            break;
+          default:
+            key.Append(System.Convert.ToString(props[i], CultureInfo.InvariantCulture));
+            break;
+        }
+        key.Append(';');
+      }
+      return key.ToString();
+    }
+    public static void ResetInputs(GH_Document definition)
+    {
+      // expiring the inputs drops the values of the last run and expires everything downstream,
+      // so the next run of the document solves as if it was freshly extracted
+      foreach (var obj in definition.Objects)
+      {
+        if (obj is IGH_Param param && param.Sources.Count == 0 && IsInputName(param.NickName))
+          param.ExpireSolution(false);
+      }
+    }
     private static bool IsInputName(string name) => name.StartsWith("BcIn_");
     private static string FormatName(string name) => name.Substring(5);
   }
@@ -49,5 +49,10 @@ namespace GH_BC.UI
 
     [DllImport("USER32", SetLastError = true)]
     internal static extern IntPtr SetFocus(IntPtr hWnd);
+
+    [DllImport("USER32")]
+    internal static extern uint GetQueueStatus(uint flags);
+    // mouse or keyboard input is waiting in the queue of the calling thread
+    internal static bool HasPendingInput() => (GetQueueStatus(0x0407 /*QS_INPUT*/) >> 16) != 0;
   }
 }
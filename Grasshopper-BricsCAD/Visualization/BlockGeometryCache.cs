@@ -0,0 +1,187 @@
+using System.Collections.Generic;
+using Teigha.DatabaseServices;
+using Teigha.Geometry;
+using Teigha.GraphicsInterface;
+
+namespace GH_BC.Visualization
+{
+  // one insert of a block previewed through BlockGeometryCache
+  struct BlockInstance
+  {
+    public ObjectId BlockId;
+    public Matrix3d Transform;
+    public BlockInstance(ObjectId blockId, Matrix3d transform)
+    {
+      BlockId = blockId;
+      Transform = transform;
+    }
+  }
+
+  // Clones of the entities of every previewed block table record, drawn under the transform of each insert.
+  // Nested inserts (every cell of a nested MInsert) are kept as instances of their own record, so memory
+  // follows the number of distinct blocks. The preview color is picked at draw time: each color drawn gets
+  // its own set of clones, colored once, so inserts drawn in different colors never share mutable state.
+  // A record is read again once it or one of its entities is modified or erased.
+  static class BlockGeometryCache
+  {
+    private class BlockGeometry
+    {
+      public List<Entity> Entities = new List<Entity>();
+      public Dictionary<System.Drawing.Color, List<Entity>> Colored = new Dictionary<System.Drawing.Color, List<Entity>>();
+      public List<BlockInstance> Nested = new List<BlockInstance>();
+    }
+    private static Dictionary<ObjectId, BlockGeometry> _blocks = new Dictionary<ObjectId, BlockGeometry>();
+    private static HashSet<Database> _databases = new HashSet<Database>();
+    public static int Count => _blocks.Count;
+
+    public static bool WorldDraw(BlockInstance instance, WorldDraw wd, System.Drawing.Color color)
+    {
+      var block = GetBlock(instance.BlockId);
+      if (block == null)
+        return true;
+
+      bool isVpDrawable = false;
+      wd.Geometry.PushModelTransform(instance.Transform);
+      try
+      {
+        foreach (var ent in ColoredEntities(block, color))
+        {
+          if (!ent.WorldDraw(wd))
+            isVpDrawable = true;
+        }
+        foreach (var nested in block.Nested)
+        {
+          if (!WorldDraw(nested, wd, color))
+            isVpDrawable = true;
+        }
+      }
+      finally
+      {
+        wd.Geometry.PopModelTransform();
+      }
+      return !isVpDrawable;
+    }
+    public static void ViewportDraw(BlockInstance instance, ViewportDraw vd, System.Drawing.Color color)
+    {
+      var block = GetBlock(instance.BlockId);
+      if (block == null)
+        return;
+
+      vd.Geometry.PushModelTransform(instance.Transform);
+      try
+      {
+        foreach (var ent in ColoredEntities(block, color))
+          ent.ViewportDraw(vd);
+        foreach (var nested in block.Nested)
+          ViewportDraw(nested, vd, color);
+      }
+      finally
+      {
+        vd.Geometry.PopModelTransform();
+      }
+    }
+    public static void Invalidate(ObjectId blockId)
+    {
+      if (!_blocks.TryGetValue(blockId, out var block))
+        return;
+
+      block.Entities.ForEach(ent => ent.Dispose());
+      foreach (var colored in block.Colored.Values)
+        colored.ForEach(ent => ent.Dispose());
+      _blocks.Remove(blockId);
+    }
+    public static void Clear(Database database)
+    {
+      if (!_databases.Remove(database))
+        return;
+
+      database.ObjectModified -= OnObjectModified;
+      database.ObjectErased -= OnObjectErased;
+      var blockIds = new List<ObjectId>();
+      foreach (var blockId in _blocks.Keys)
+      {
+        if (blockId.Database == database)
+          blockIds.Add(blockId);
+      }
+      blockIds.ForEach(Invalidate);
+    }
+    private static BlockGeometry GetBlock(ObjectId blockId)
+    {
+      if (_blocks.TryGetValue(blockId, out var block))
+        return block;
+      if (!blockId.IsValid || blockId.IsErased)
+        return null;
+
+      block = new BlockGeometry();
+      using (var transaction = blockId.Database.TransactionManager.StartTransaction())
+      {
+        if (!(transaction.GetObject(blockId, OpenMode.ForRead) is BlockTableRecord btr))
+          return null;
+
+        foreach (var id in btr)
+        {
+          var ent = transaction.GetObject(id, OpenMode.ForRead) as Entity;
+          if (ent is MInsertBlock mInsert)
+            AddCells(block.Nested, mInsert);
+          else if (ent is BlockReference blockRef)
+            block.Nested.Add(new BlockInstance(blockRef.BlockTableRecord, blockRef.BlockTransform));
+          else if (ent != null)
+            block.Entities.Add((Entity) ent.Clone());
+        }
+        transaction.Commit();
+      }
+
+      var database = blockId.Database;
+      if (_databases.Add(database))
+      {
+        database.ObjectModified += OnObjectModified;
+        database.ObjectErased += OnObjectErased;
+      }
+      _blocks.Add(blockId, block);
+      return block;
+    }
+    // one instance per row and column, the cells are offset in the rotated plane of the insert
+    private static void AddCells(List<BlockInstance> instances, MInsertBlock mInsert)
+    {
+      var toWorld = Matrix3d.PlaneToWorld(mInsert.Normal) * Matrix3d.Rotation(mInsert.Rotation, Vector3d.ZAxis, Point3d.Origin);
+      for (int row = 0; row < mInsert.Rows; ++row)
+      {
+        for (int column = 0; column < mInsert.Columns; ++column)
+        {
+          var offset = new Vector3d(column * mInsert.ColumnSpacing, row * mInsert.RowSpacing, 0.0).TransformBy(toWorld);
+          instances.Add(new BlockInstance(mInsert.BlockTableRecord, Matrix3d.Displacement(offset) * mInsert.BlockTransform));
+        }
+      }
+    }
+    private static List<Entity> ColoredEntities(BlockGeometry block, System.Drawing.Color color)
+    {
+      if (block.Colored.TryGetValue(color, out var colored))
+        return colored;
+
+      var entColor = Teigha.Colors.Color.FromColor(color);
+      colored = new List<Entity>(block.Entities.Count);
+      foreach (var ent in block.Entities)
+      {
+        var clone = (Entity) ent.Clone();
+        clone.Color = entColor;
+        colored.Add(clone);
+      }
+      block.Colored.Add(color, colored);
+      return colored;
+    }
+    private static void OnObjectModified(object sender, ObjectEventArgs e)
+    {
+      if (e.DBObject is BlockTableRecord)
+        Invalidate(e.DBObject.ObjectId);
+      else if (e.DBObject is Entity)
+        Invalidate(e.DBObject.OwnerId);
+    }
+    private static void OnObjectErased(object sender, ObjectErasedEventArgs e)
+    {
+      if (e.DBObject is BlockTableRecord)
+        Invalidate(e.DBObject.ObjectId);
+      else if (e.DBObject is Entity)
+        Invalidate(e.DBObject.OwnerId);
+    }
+  }
+}
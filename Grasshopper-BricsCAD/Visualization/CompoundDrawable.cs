@@ -8,21 +8,37 @@ namespace GH_BC.Visualization
   class CompoundDrawable : Drawable
   {
     private List<PreviewDrawable> _drawables = new List<PreviewDrawable>();
-    private List<BlockReference> _blockRefs = new List<BlockReference>();
+    private List<BlockInstance> _blockRefs = new List<BlockInstance>();
     private List<PreviewDrawable> _selectedDrawables = new List<PreviewDrawable>();
-    private List<BlockReference> _selectedblockRefs = new List<BlockReference>();
+    private List<BlockInstance> _selectedblockRefs = new List<BlockInstance>();
     public bool IsRenderMode { get; set; }
+    // database the preview is drawn in, its visual styles are used
+    public Database Database { get; set; }
     public System.Drawing.Color Color { get; set; }
     public System.Drawing.Color ColorSelected { get; set; }
     public override bool IsPersistent => false;
     public override ObjectId Id { get; }
+    public CompoundDrawable()
+    {
+    }
+    // shares the preview of the given drawable, display state (colors, render mode, database) is its own
+    public CompoundDrawable(CompoundDrawable preview)
+    {
+      _drawables = preview._drawables;
+      _blockRefs = preview._blockRefs;
+      _selectedDrawables = preview._selectedDrawables;
+      _selectedblockRefs = preview._selectedblockRefs;
+    }
+    public int BlockRefCount => _blockRefs.Count + _selectedblockRefs.Count;
+    public IEnumerable<Rhino.Geometry.GeometryBase> Geometry(bool isSelected) =>
+      (isSelected ? _selectedDrawables : _drawables).Select(drawable => drawable.Geometry);
     public void AddDrawable(PreviewDrawable drawable, bool isSelected)
     {
       (isSelected ? _selectedDrawables : _drawables).Add(drawable);
     }
-    public void AddBlockRef(BlockReference blockReference, bool isSelected)
+    public void AddBlockRef(BlockInstance blockInstance, bool isSelected)
     {
-      (isSelected ? _selectedblockRefs : _blockRefs).Add(blockReference);
+      (isSelected ? _selectedblockRefs : _blockRefs).Add(blockInstance);
     }
     public void Clear()
     {
@@ -37,7 +53,7 @@ namespace GH_BC.Visualization
       {
         if (traits is SubEntityTraits subEntTraits)
         {
-          var db = Bricscad.ApplicationServices.Application.DocumentManager.MdiActiveDocument.Database;
+          var db = Database ?? Bricscad.ApplicationServices.Application.DocumentManager.MdiActiveDocument.Database;
           subEntTraits.VisualStyle = DatabaseUtils.VisualStyleId(db, IsRenderMode ? DatabaseUtils.Realistic :
                                                                                     DatabaseUtils.Wirframe);
           subEntTraits.SelectionFlags = SelectionFlags.SelectionIgnore;
@@ -52,10 +68,12 @@ namespace GH_BC.Visualization
       {
         SetColor(wd.SubEntityTraits, Color);
         drawablesForViewport = _drawables.Count(drawable => !drawable.WorldDraw(wd));
-        drawablesForViewport += _blockRefs.Count(blockRef => worldDrawBlockRef(blockRef, wd, Color));
+        foreach (var blockRef in _blockRefs)
+          drawablesForViewport += BlockGeometryCache.WorldDraw(blockRef, wd, Color) ? 0 : 1;
         SetColor(wd.SubEntityTraits, ColorSelected);
         drawablesForViewport += _selectedDrawables.Count(drawable => !drawable.WorldDraw(wd));
-        drawablesForViewport += _selectedblockRefs.Count(blockRef => worldDrawBlockRef(blockRef, wd, ColorSelected));
+        foreach (var blockRef in _selectedblockRefs)
+          drawablesForViewport += BlockGeometryCache.WorldDraw(blockRef, wd, ColorSelected) ? 0 : 1;
       }
       return drawablesForViewport == 0;
     }
@@ -65,10 +83,12 @@ namespace GH_BC.Visualization
       {
         SetColor(vd.SubEntityTraits, Color);
         _drawables.ForEach(drawable => drawable.ViewportDraw(vd));
-        _blockRefs.ForEach(blockRef => vpDrawBlockRef(blockRef, vd, Color));
+        foreach (var blockRef in _blockRefs)
+          BlockGeometryCache.ViewportDraw(blockRef, vd, Color);
         SetColor(vd.SubEntityTraits, ColorSelected);
         _selectedDrawables.ForEach(drawable => drawable.ViewportDraw(vd));
-        _selectedblockRefs.ForEach(blockRef => vpDrawBlockRef(blockRef, vd, ColorSelected));
+        foreach (var blockRef in _selectedblockRefs)
+          BlockGeometryCache.ViewportDraw(blockRef, vd, ColorSelected);
       }
     }
     protected override int SubViewportDrawLogicalFlags(ViewportDraw vd) => (int) AttributesFlags.DrawableNone;
@@ -78,44 +98,5 @@ namespace GH_BC.Visualization
       st.Transparency = new Teigha.Colors.Transparency(color.A);
     }
 
-    private bool worldDrawBlockRef(BlockReference blockRef, WorldDraw wd, System.Drawing.Color color)
-    {
-
-      DBObjectCollection dbcol = new DBObjectCollection();
-      bool isVpDrawable = false;
-      blockRef.Explode(dbcol);
-      foreach (var dbObj in dbcol)
-      {
-        if (dbObj is BlockReference blockReference)
-        {
-          if (!worldDrawBlockRef(blockReference, wd, color))
-            isVpDrawable = true;
-        }
-        else if (dbObj is Entity ent)
-        {
-          ent.Color = Teigha.Colors.Color.FromColor(color);
-          if (!ent.WorldDraw(wd))
-            isVpDrawable = true;
-        }
-      }
-      return !isVpDrawable;
-    }
-
-    private void vpDrawBlockRef(BlockReference blockRef, ViewportDraw vd, System.Drawing.Color color)
-    {
-      DBObjectCollection dbcol = new DBObjectCollection();
-      blockRef.Explode(dbcol);
-      foreach (var dbObj in dbcol)
-      {
-        if (dbObj is BlockReference blockReference)
-          vpDrawBlockRef(blockReference, vd, color);
-        else if (dbObj is Entity ent)
-        {
-          ent.Color = Teigha.Colors.Color.FromColor(color);
-          ent.ViewportDraw(vd);
-        }
-      }
-    }
-
   }
 }
@@ -34,32 +34,19 @@ namespace GH_BC.Visualization
     {
       if (drawable is Entity ent)
       {
-        var id = GrasshopperData.GetGrasshopperData(ent);
-        if (!id.IsNull)
+        var docExt = GhBcConnection.GrasshopperDataExtension.GrasshopperDataManager(ent.Database);
+        var hostInfo = docExt?.GetHostInfo(ent) ?? new GhDataHostInfo();
+        if (hostInfo.IsVisible)
         {
-          var database = id.Database;
-          var docExt = GhBcConnection.GrasshopperDataExtension.GrasshopperDataManager(database);
-          var ghDrawable = docExt?.GetGhDrawable(id);
+          var ghDrawable = docExt.GetGhDrawable(hostInfo.GhDataId);
           if (ghDrawable == null || ghDrawable.IsDisposed)
             return base.WorldDraw(drawable, wd);
 
-          bool needToDraw = false;
-          using (var transaction = database.TransactionManager.StartTransaction())
+          using (var trSt = new TraitsState(wd.SubEntityTraits))
           {
-            using (var ghData = transaction.GetObject(id, OpenMode.ForRead) as GrasshopperData)
-            {
-              needToDraw = ghData.IsVisible;
-            }
-            transaction.Commit();
-          }
-          if(needToDraw)
-          {
-            using (var trSt = new TraitsState(wd.SubEntityTraits))
-            {
-              wd.Geometry.Draw(ghDrawable);
-            }
-            wd.SubEntityTraits.Transparency = new Transparency((byte) GhDataSettings.HostTransparency);
+            wd.Geometry.Draw(ghDrawable);
           }
+          wd.SubEntityTraits.Transparency = new Transparency((byte) GhDataSettings.HostTransparency);
         }
       }
       return base.WorldDraw(drawable, wd);
@@ -4,6 +4,7 @@ using Grasshopper;
 using System.Collections.Generic;
 using System.Linq;
 using System;
+using System.Threading.Tasks;
 using Rhino.Geometry;
 using _OdDb = Teigha.DatabaseServices;
 using _OdGe = Teigha.Geometry;
@@ -13,6 +14,21 @@ namespace GH_BC.Visualization
 {
   class GrasshopperPreview : IDisposable
   {
+    // drawables extracted from one object of the definition, kept until the object expires
+    private class SceneEntry
+    {
+      public List<PreviewDrawable> Drawables = new List<PreviewDrawable>();
+      public List<BlockInstance> BlockRefs = new List<BlockInstance>();
+      public bool Expired = true;
+      public void ClearDrawables()
+      {
+        Drawables.ForEach(drawable => drawable.ReleaseTessellation());
+        Drawables.Clear();
+      }
+    }
+    private Dictionary<IGH_ActiveObject, SceneEntry> _scene = new Dictionary<IGH_ActiveObject, SceneEntry>();
+    private bool _sceneRenderMode = false;
+    private bool _sceneSettingsChanged = false;
     private GH_Document _activeDefinition = null;
     private readonly Teigha.Geometry.IntegerCollection _vieportNums = new Teigha.Geometry.IntegerCollection();
     private List<IGH_DocumentObject> _lastSelection = new List<IGH_DocumentObject>();
@@ -25,6 +41,7 @@ namespace GH_BC.Visualization
     }
     public void Dispose()
     {
+      ClearScene();
       GhDrawingContext.LinkedDocument.TransientGraphicsManager()?.EraseTransient(_compoundDrawable, _vieportNums);
       GC.SuppressFinalize(this);
     }
@@ -38,6 +55,7 @@ namespace GH_BC.Visualization
       {
         GhDrawingContext.NeedRedraw = true;
         UnhighlightBcData();
+        ClearScene();
         if (_activeDefinition != null)
         {
           if (editor != null) editor.VisibleChanged -= Editor_VisibleChanged;
@@ -88,6 +106,8 @@ namespace GH_BC.Visualization
     }
     private void ActiveDefinition_SettingsChanged(object sender, GH_DocSettingsEventArgs e)
     {
+      //mesh settings are part of the settings, re-extract everything
+      _sceneSettingsChanged = true;
       GhDrawingContext.NeedRedraw = true;
     }
     private void ActiveDefinition_ModifiedChanged(object sender, GH_DocModifiedEventArgs e)
@@ -104,6 +124,7 @@ namespace GH_BC.Visualization
       var graphicsManager = GhDrawingContext.LinkedDocument.TransientGraphicsManager();
       graphicsManager.AddTransient(_compoundDrawable, TransientDrawingMode.Main, 128, _vieportNums);
       _compoundDrawable.Clear();
+      _compoundDrawable.Database = GhDrawingContext.LinkedDocument.Database;
       if (_activeDefinition == null)
       {
         graphicsManager.UpdateTransient(_compoundDrawable, _vieportNums);
@@ -115,23 +136,114 @@ namespace GH_BC.Visualization
       if (_activeDefinition.PreviewMode != GH_PreviewMode.Disabled && Instances.EtoDocumentEditor.Visible)
       {
         _compoundDrawable.IsRenderMode = _activeDefinition.PreviewMode == GH_PreviewMode.Shaded;
-        Action<IGH_ActiveObject> onBcObject = (obj) =>
+        UpdateScene();
+      }
+      else
+      {
+        UnhighlightBcData();
+      }
+      graphicsManager.UpdateTransient(_compoundDrawable, _vieportNums);
+    }
+    // Only objects expired since the last build are extracted (and meshed) again, the drawables of
+    // the others are reused. A selection change just moves drawables between the colour groups.
+    private void UpdateScene()
+    {
+      var isRenderMode = _compoundDrawable.IsRenderMode;
+      if (_sceneSettingsChanged || isRenderMode != _sceneRenderMode)
+      {
+        foreach (var entry in _scene.Values)
+          entry.Expired = true;
+        _sceneSettingsChanged = false;
+        _sceneRenderMode = isRenderMode;
+      }
+
+      var meshParameters = _activeDefinition.PreviewCurrentMeshParameters() ?? Rhino.Geometry.MeshingParameters.Default;
+      var objects = new HashSet<IGH_ActiveObject>();
+      var toExtract = new List<IGH_ActiveObject>();
+      var toExtractEntries = new List<SceneEntry>();
+      foreach (var obj in _activeDefinition.Objects.OfType<IGH_ActiveObject>())
+      {
+        objects.Add(obj);
+        var entry = obj is IGH_PreviewObject ? GetSceneEntry(obj) : null;
+        if (obj.Locked)
+          continue;
+
+        bool isSelected = obj.Attributes.Selected;
+        if (_activeDefinition.PreviewFilter == GH_PreviewFilter.Selected && !isSelected)
+          continue;
+
+        if (!(obj is IGH_PreviewObject previewObject))
         {
           if (obj.Category == "BricsCAD" && obj is IGH_Param param)
             HighlightBcData(param);
-        };
-        Action<IGH_ActiveObject> onSuccessfulExtract = (obj) =>
+        }
+        else if (previewObject.IsPreviewCapable && !previewObject.Hidden)
+        {
+          if (entry.Expired)
+          {
+            toExtract.Add(obj);
+            toExtractEntries.Add(entry);
+          }
+          else
+            entry.Drawables.ForEach(drawable => _compoundDrawable.AddDrawable(drawable, isSelected));
+        }
+        else if (!previewObject.Hidden && previewObject is GH_BC.Components.InsertBlockReference blockComponent)
         {
-          obj.ObjectChanged += ObjectChanged;
-        };
+          if (entry.Expired)
+          {
+            entry.ClearDrawables();
+            entry.BlockRefs.Clear();
+            getBlockRefPreview(blockComponent, entry.BlockRefs);
+            entry.Expired = false;
+          }
+          entry.BlockRefs.ForEach(blockRef => _compoundDrawable.AddBlockRef(blockRef, isSelected));
+        }
+      }
 
-        GetPreview(_activeDefinition, _compoundDrawable, onBcObject, onSuccessfulExtract);
+      var extracted = ExtractGeometry(toExtract, isRenderMode, meshParameters);
+      for (int i = 0; i < toExtract.Count; ++i)
+      {
+        var entry = toExtractEntries[i];
+        entry.ClearDrawables();
+        entry.Drawables = extracted[i].Select(geom => new PreviewDrawable(geom)).ToList();
+        entry.BlockRefs.Clear();
+        entry.Expired = false;
+        bool isSelected = toExtract[i].Attributes.Selected;
+        entry.Drawables.ForEach(drawable => _compoundDrawable.AddDrawable(drawable, isSelected));
       }
-      else
+
+      foreach (var removed in _scene.Keys.Where(obj => !objects.Contains(obj)).ToList())
+        RemoveSceneEntry(removed);
+    }
+    private SceneEntry GetSceneEntry(IGH_ActiveObject obj)
+    {
+      if (!_scene.TryGetValue(obj, out var entry))
       {
-        UnhighlightBcData();
+        entry = new SceneEntry();
+        obj.ObjectChanged += ObjectChanged;
+        obj.SolutionExpired += ObjectSolutionExpired;
+        _scene.Add(obj, entry);
       }
-      graphicsManager.UpdateTransient(_compoundDrawable, _vieportNums);
+      return entry;
+    }
+    private void RemoveSceneEntry(IGH_ActiveObject obj)
+    {
+      obj.ObjectChanged -= ObjectChanged;
+      obj.SolutionExpired -= ObjectSolutionExpired;
+      if (_scene.TryGetValue(obj, out var entry))
+        entry.ClearDrawables();
+      _scene.Remove(obj);
+    }
+    private void ClearScene()
+    {
+      foreach (var obj in _scene.Keys.ToList())
+        RemoveSceneEntry(obj);
+      _compoundDrawable?.Clear();
+    }
+    private void ObjectSolutionExpired(IGH_DocumentObject sender, GH_SolutionExpiredEventArgs e)
+    {
+      if (sender is IGH_ActiveObject obj && _scene.TryGetValue(obj, out var entry))
+        entry.Expired = true;
     }
     private void ObjectChanged(IGH_DocumentObject sender, GH_ObjectChangedEventArgs e)
     {
@@ -163,33 +275,77 @@ namespace GH_BC.Visualization
       }
       _bcSelection.Clear();
     }
-    private static void ExtractGeometry(Grasshopper.Kernel.Data.IGH_Structure volatileData,
-                                        ref List<Rhino.Geometry.GeometryBase> resGeom,
-                                        bool isRenderMode,
-                                        Rhino.Geometry.MeshingParameters meshParams)
+    // Geometry of the previewable outputs of several objects, one list per object. Script values are
+    // read on the calling thread, meshing and wireframing run concurrently on the thread pool.
+    private static List<Rhino.Geometry.GeometryBase>[] ExtractGeometry(IList<IGH_ActiveObject> objs,
+                                                                       bool isRenderMode,
+                                                                       Rhino.Geometry.MeshingParameters meshParams)
+    {
+      var owners = new List<int>();
+      var values = new List<object>();
+      for (int i = 0; i < objs.Count; ++i)
+      {
+        if (objs[i] is IGH_Component component)
+        {
+          foreach (var param in component.Params.Output)
+            CollectPreviewValues(param.VolatileData, i, owners, values);
+        }
+        else if (objs[i] is IGH_Param param)
+          CollectPreviewValues(param.VolatileData, i, owners, values);
+      }
+
+      var converted = new List<Rhino.Geometry.GeometryBase>[values.Count];
+      var options = new ParallelOptions { MaxDegreeOfParallelism = GhDataSettings.MeshThreads };
+      Parallel.For(0, values.Count, options, k =>
+      {
+        converted[k] = new List<Rhino.Geometry.GeometryBase>();
+        ToPreviewGeometry(values[k], converted[k], isRenderMode, meshParams);
+      });
+
+      var res = new List<Rhino.Geometry.GeometryBase>[objs.Count];
+      for (int i = 0; i < objs.Count; ++i)
+        res[i] = new List<Rhino.Geometry.GeometryBase>();
+      for (int k = 0; k < values.Count; ++k)
+        res[owners[k]].AddRange(converted[k]);
+      return res;
+    }
+    private static void CollectPreviewValues(Grasshopper.Kernel.Data.IGH_Structure volatileData,
+                                             int owner, List<int> owners, List<object> values)
     {
       foreach (var value in volatileData.AllData(true))
       {
         if (value is IGH_PreviewData)
-          ExtractGeometry(value, ref resGeom, isRenderMode, meshParams);
+          CollectPreviewValues(value, owner, owners, values);
       }
     }
-    private static void ExtractGeometry(Grasshopper.Kernel.Types.IGH_Goo iGoo,
-                                        ref List<Rhino.Geometry.GeometryBase> resGeom,
-                                        bool isRenderMode,
-                                        Rhino.Geometry.MeshingParameters meshParams)
+    private static void CollectPreviewValues(IGH_Goo iGoo, int owner, List<int> owners, List<object> values)
     {
       if (iGoo is Grasshopper.Kernel.Types.GH_GeometryGroup group)
       {
         foreach (var geomGoo in group.Objects)
-          ExtractGeometry(geomGoo, ref resGeom, isRenderMode, meshParams);
+          CollectPreviewValues(geomGoo, owner, owners, values);
         return;
       }
 
+      try
+      {
+        values.Add(iGoo.ScriptVariable());
+        owners.Add(owner);
+      }
+      catch (Exception e)
+      {
+        System.Diagnostics.Debug.Fail(e.Source, e.Message);
+      }
+    }
+    private static void ToPreviewGeometry(object value,
+                                          List<Rhino.Geometry.GeometryBase> resGeom,
+                                          bool isRenderMode,
+                                          Rhino.Geometry.MeshingParameters meshParams)
+    {
       Rhino.Geometry.GeometryBase geometryBase = null;
       try
       {
-        switch (iGoo.ScriptVariable())
+        switch (value)
         {
           case Rhino.Geometry.Point3d point:
             geometryBase = new Rhino.Geometry.Point(point);
@@ -243,7 +399,7 @@ namespace GH_BC.Visualization
             }
           default:
             {
-              System.Diagnostics.Debug.Fail("Not supported GH type", iGoo.GetType().ToString());
+              System.Diagnostics.Debug.Fail("Not supported GH type", value?.GetType().ToString());
               break;
             }
         }
@@ -262,6 +418,7 @@ namespace GH_BC.Visualization
       var meshParameters = definition.PreviewCurrentMeshParameters() ?? Rhino.Geometry.MeshingParameters.Default;
       var isRenderMode = definition.PreviewMode == GH_PreviewMode.Shaded;
 
+      var toExtract = new List<IGH_ActiveObject>();
       foreach (var obj in definition.Objects.OfType<IGH_ActiveObject>())
       {
         if (obj.Locked)
@@ -274,25 +431,12 @@ namespace GH_BC.Visualization
         if (obj is IGH_PreviewObject previewObject)
         {
           if (previewObject.IsPreviewCapable && !previewObject.Hidden)
-          {
-            var geometries = new List<Rhino.Geometry.GeometryBase>();
-            if (obj is IGH_Component component)
-            {
-              foreach (var param in component.Params.Output)
-                ExtractGeometry(param.VolatileData, ref geometries, isRenderMode, meshParameters);
-            }
-            else if (obj is IGH_Param param)
-              ExtractGeometry(param.VolatileData, ref geometries, isRenderMode, meshParameters);
-
-            if (geometries.Count != 0)
-            {
-              geometries.ForEach(geom => compoundDrawable.AddDrawable(new PreviewDrawable(geom), isSelected));
-              onSuccessfulExtract?.Invoke(obj);
-            }
-          }
+            toExtract.Add(obj);
           else if (!previewObject.Hidden && previewObject is GH_BC.Components.InsertBlockReference blockComponent)
           {
-            getBlockRefPreview(blockComponent, compoundDrawable);
+            var blockRefs = new List<BlockInstance>();
+            getBlockRefPreview(blockComponent, blockRefs);
+            blockRefs.ForEach(blockRef => compoundDrawable.AddBlockRef(blockRef, isSelected));
           }
         }
         else
@@ -300,9 +444,20 @@ namespace GH_BC.Visualization
           onNotDrawble?.Invoke(obj);
         }
       }
+
+      var extracted = ExtractGeometry(toExtract, isRenderMode, meshParameters);
+      for (int i = 0; i < toExtract.Count; ++i)
+      {
+        if (extracted[i].Count == 0)
+          continue;
+
+        bool isSelected = toExtract[i].Attributes.Selected;
+        extracted[i].ForEach(geom => compoundDrawable.AddDrawable(new PreviewDrawable(geom), isSelected));
+        onSuccessfulExtract?.Invoke(toExtract[i]);
+      }
     }
 
-    private static void getBlockRefPreview(GH_BC.Components.InsertBlockReference blockComponent, CompoundDrawable compoundDrawable)
+    private static void getBlockRefPreview(GH_BC.Components.InsertBlockReference blockComponent, List<BlockInstance> blockRefs)
     {
       List<IGH_Param> inputParams = blockComponent.Params.Input;
       var handleData = inputParams[blockComponent.Params.IndexOfInputParam("Block Definition")].VolatileData;
@@ -353,13 +508,14 @@ namespace GH_BC.Visualization
 
           // explode input only has an influence on the number of previews shown, but not the actual preview
 
-          var blockRef = new _OdDb.BlockReference(insertionPoint.ToHost(), btrId)
+          using (var blockRef = new _OdDb.BlockReference(insertionPoint.ToHost(), btrId)
           {
             Rotation = rotation,
             ScaleFactors = new _OdGe.Scale3d(scale.X, scale.Y, scale.Z)
-          };
-
-          compoundDrawable.AddBlockRef(blockRef, blockComponent.Attributes.Selected);
+          })
+          {
+            blockRefs.Add(new BlockInstance(btrId, blockRef.BlockTransform));
+          }
         }
       }
     }
@@ -1,37 +1,115 @@
+using System.Collections.Generic;
 using Teigha.Geometry;
 using Teigha.GraphicsInterface;
 
 namespace GH_BC.Visualization
 {
+  // Curve polylines shared by all previews, one per curve and deviation bucket. A bucket covers
+  // deviations from 2^n to 2^(n+1) and is tessellated at 2^n, so zooming within the band reuses it.
+  static class CurveTessellationCache
+  {
+    public class Entry
+    {
+      public Dictionary<int, LinkedListNode<Entry>> Owner;
+      public int Bucket;
+      public Polyline Polyline;
+      public long Bytes;
+    }
+    private static LinkedList<Entry> _lru = new LinkedList<Entry>();
+    public static long MaxBytes { get; set; } = 64L * 1024 * 1024;
+    public static long BytesHeld { get; private set; }
+    public static int Bucket(double deviation) => deviation > 0.0 ? (int) System.Math.Floor(System.Math.Log(deviation, 2.0)) : int.MinValue;
+    public static double BucketDeviation(int bucket) => System.Math.Pow(2.0, bucket);
+    public static Polyline Find(Dictionary<int, LinkedListNode<Entry>> owner, int bucket)
+    {
+      if (!owner.TryGetValue(bucket, out var node))
+        return null;
+
+      _lru.Remove(node);
+      _lru.AddFirst(node);
+      return node.Value.Polyline;
+    }
+    public static void Add(Dictionary<int, LinkedListNode<Entry>> owner, int bucket, Polyline polyline)
+    {
+      var entry = new Entry { Owner = owner, Bucket = bucket, Polyline = polyline, Bytes = polyline.Points.Count * 24L };
+      owner[bucket] = _lru.AddFirst(entry);
+      BytesHeld += entry.Bytes;
+      while (BytesHeld > MaxBytes && _lru.Count > 1)
+        Remove(_lru.Last);
+    }
+    // drops all polylines of one curve, for previews which are discarded
+    public static void Release(Dictionary<int, LinkedListNode<Entry>> owner)
+    {
+      foreach (var node in new List<LinkedListNode<Entry>>(owner.Values))
+        Remove(node);
+    }
+    private static void Remove(LinkedListNode<Entry> node)
+    {
+      _lru.Remove(node);
+      node.Value.Owner.Remove(node.Value.Bucket);
+      BytesHeld -= node.Value.Bytes;
+      node.Value.Polyline.Dispose();
+    }
+  }
+
   class PreviewDrawable
   {
     private Rhino.Geometry.GeometryBase _geometry;
+    // polylines of a curve per deviation bucket, see CurveTessellationCache
+    private Dictionary<int, LinkedListNode<CurveTessellationCache.Entry>> _polylines;
+    private double _curveLength;
+    // host shell of a mesh, converted once when the preview is built
+    private Point3dCollection _shellPoints;
+    private IntegerCollection _shellFaces;
+    private VertexData _shellVertexData;
     public PreviewDrawable(Rhino.Geometry.GeometryBase geo)
     {
       _geometry = geo;
+      if (_geometry is Rhino.Geometry.Mesh mesh)
+        BuildShell(mesh);
+      else if (_geometry is Rhino.Geometry.Curve curve)
+      {
+        _curveLength = curve.GetLength();
+        _polylines = new Dictionary<int, LinkedListNode<CurveTessellationCache.Entry>>();
+      }
+    }
+    private void BuildShell(Rhino.Geometry.Mesh mesh)
+    {
+      _shellFaces = mesh.Faces.ToHost();
+      _shellPoints = new Point3dCollection(mesh.Vertices.ToHost());
+      _shellVertexData = new VertexData();
+      _shellVertexData.SetNormalVectors(mesh.Normals.ToHost());
+      bool hasVertColor = mesh.VertexColors.Count != 0;
+      _shellVertexData.SetTrueColors(hasVertColor ? mesh.VertexColors.ToHost() : null);
+    }
+    public Rhino.Geometry.GeometryBase Geometry => _geometry;
+    // gives back the cached polylines, a later draw tessellates the curve again
+    public void ReleaseTessellation()
+    {
+      if (_polylines != null)
+        CurveTessellationCache.Release(_polylines);
     }
     public bool WorldDraw(WorldDraw wd)
     {
-      if (_geometry is Rhino.Geometry.Mesh mesh)
+      if (_geometry is Rhino.Geometry.Mesh)
       {
-        var faces = mesh.Faces.ToHost();
-        var points = new Point3dCollection(mesh.Vertices.ToHost());
-        var vertexData = new VertexData();
-        vertexData.SetNormalVectors(mesh.Normals.ToHost());
-        bool hasVertColor = mesh.VertexColors.Count != 0;
-        vertexData.SetTrueColors(hasVertColor ? mesh.VertexColors.ToHost() : null);
-        wd.Geometry.Shell(points, faces, null, null, vertexData, false);
+        wd.Geometry.Shell(_shellPoints, _shellFaces, null, null, _shellVertexData, false);
       }
       else if (_geometry is Rhino.Geometry.Curve curve)
       {
-        double deviation = System.Math.Max(wd.Deviation(DeviationType.MaxDevForCurve, curve.PointAtStart.ToHost()), 0.01 * curve.GetLength());
-        var polyline = curve.ToPolyline(10E+4 * Convert.VertexTolerance, Convert.AngleTolerance, deviation, 0.0);
+        double deviation = System.Math.Max(wd.Deviation(DeviationType.MaxDevForCurve, curve.PointAtStart.ToHost()), 0.01 * _curveLength);
+        int bucket = CurveTessellationCache.Bucket(deviation);
+        var giPoly = CurveTessellationCache.Find(_polylines, bucket);
+        var polyline = giPoly == null ? curve.ToPolyline(10E+4 * Convert.VertexTolerance, Convert.AngleTolerance,
+                                                         CurveTessellationCache.BucketDeviation(bucket), 0.0) : null;
         if (polyline != null)
         {
-          var giPoly = new Polyline();
+          giPoly = new Polyline();
           giPoly.Points = new Point3dCollection(polyline.ToPolyline().ToArray().ToHost());
-          wd.Geometry.Polyline(giPoly);
+          CurveTessellationCache.Add(_polylines, bucket, giPoly);
         }
+        if (giPoly != null)
+          wd.Geometry.Polyline(giPoly);
 #if DEBUG
         else
         {
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "DbGrasshopperData.h"
+#include "GhDataIndex.h"
 #include "GhProperty.h"
 
 static const ACHAR* s_ghData = L"GrasshopperData";
@@ -7,7 +8,7 @@ static const ACHAR* s_ghData = L"GrasshopperData";
 ACRX_DXF_DEFINE_MEMBERS(DbGrasshopperData,AcDbObject,AcDb::kDHL_CURRENT,AcDb::kMReleaseCurrent,
                         AcDbProxyEntity::kNoOperation,DbGrasshopperData,"Grasshopper-BricsCAD-Connection")
 
-#define CLASS_VERSION 0
+#define CLASS_VERSION 1
 
 DbGrasshopperData::DbGrasshopperData()
 {}
@@ -45,18 +46,19 @@ void DbGrasshopperData::setVisibility(bool v)
 GhPropertyTypeArray DbGrasshopperData::getPropertiesTypes() const
 {
     assertReadEnabled();
+    const auto& props = properties();
     GhPropertyTypeArray res;
-    res.reserve(m_props.size());
-    for (const auto& prop : m_props)
-        res.emplace_back(prop.first, prop.second->getType());
+    res.reserve(props.size());
+    for (const auto& prop : props)
+        res.emplace_back(prop.name, prop.value.getType());
     return res;
 }
 
 GhProperty DbGrasshopperData::getProperty(const AcString& name) const
 {
     assertReadEnabled();
-    auto i = m_props.find(name);
-    return i == m_props.end() ? GhProperty() : *i->second;
+    auto pProp = properties().find(name);
+    return pProp ? *pProp : GhProperty();
 }
 
 bool DbGrasshopperData::updateProperty(const AcString& name, const GhProperty& value)
@@ -64,33 +66,99 @@ bool DbGrasshopperData::updateProperty(const AcString& name, const GhProperty& v
     if (value.isEmpty())
         return false;
 
-    auto i = m_props.find(name);
-    if (i == m_props.end())
+    auto pProp = properties().find(name);
+    if (!pProp)
         return false;
 
-    if (i->second->getType() != value.getType())
+    if (pProp->getType() != value.getType())
         return false;
 
     assertWriteEnabled();
-    (*i->second) = value;
+    *pProp = value;
     return true;
 }
 
+void DbGrasshopperData::getProperties(const std::vector<AcString>& names, std::vector<GhProperty>& values) const
+{
+    assertReadEnabled();
+    values.resize(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        auto pProp = properties().find(names[i]);
+        values[i] = pProp ? *pProp : GhProperty();
+    }
+}
+
+size_t DbGrasshopperData::updateProperties(const GhPropertyArray& values)
+{
+    std::vector<std::pair<GhProperty*, const GhProperty*>> toUpdate;
+    toUpdate.reserve(values.size());
+    for (const auto& value : values)
+    {
+        if (value.second.isEmpty())
+            continue;
+
+        auto pProp = properties().find(value.first);
+        if (pProp && pProp->getType() == value.second.getType())
+            toUpdate.emplace_back(pProp, &value.second);
+    }
+    if (toUpdate.empty())
+        return 0;
+
+    assertWriteEnabled();
+    for (const auto& update : toUpdate)
+        *update.first = *update.second;
+    return toUpdate.size();
+}
+
 bool DbGrasshopperData::addProperty(const AcString& name, const GhProperty& value)
 {
-    auto i = m_props.lower_bound(name);
-    if ((i != m_props.end() && i->first == name) || value.isEmpty())
+    if (value.isEmpty() || properties().find(name))
         return false;
 
     assertWriteEnabled();
-    m_props.emplace_hint(i, name, std::make_unique<GhProperty>(value));
-    return true;
+    return properties().insert(name, value);
 }
 
 void DbGrasshopperData::clearProperties()
 {
     assertWriteEnabled();
     m_props.clear();
+    m_lazyNames.clear();
+    m_lazyValues.clear();
+}
+
+const GhProperties& DbGrasshopperData::properties() const
+{
+    if (!m_lazyNames.empty())
+        materializeProperties();
+    return m_props;
+}
+
+GhProperties& DbGrasshopperData::properties()
+{
+    if (!m_lazyNames.empty())
+        materializeProperties();
+    return m_props;
+}
+
+void DbGrasshopperData::materializeProperties() const
+{
+    m_props.reserve(m_lazyNames.size());
+    const Adesk::UInt8* pData = m_lazyValues.data();
+    const Adesk::UInt8* pEnd = pData + m_lazyValues.size();
+    for (auto propName : m_lazyNames)
+    {
+        GhProperty duplicate;
+        auto pProp = m_props.emplaceInterned(propName);
+        if (!(pProp ? pProp : &duplicate)->unpackValue(pData, pEnd))
+        {
+            assert(false);
+            break;
+        }
+    }
+    std::vector<const ACHAR*>().swap(m_lazyNames);
+    std::vector<Adesk::UInt8>().swap(m_lazyValues);
 }
 
 AcDbObjectId DbGrasshopperData::getHostEntity() const
@@ -107,6 +175,26 @@ AcDbObjectId DbGrasshopperData::getHostEntity() const
     return pDict->ownerId();
 }
 
+// true if the block holds exactly valueCount packed values
+static bool isValueBlockComplete(size_t valueCount, const std::vector<Adesk::UInt8>& valueBlock)
+{
+    const Adesk::UInt8* pData = valueBlock.data();
+    const Adesk::UInt8* pEnd = pData + valueBlock.size();
+    for (size_t i = 0; i < valueCount; ++i)
+    {
+        if (!GhProperty::skipValue(pData, pEnd))
+            return false;
+    }
+    return pData == pEnd;
+}
+
+static void writeValueBlock(AcDbDwgFiler* pFiler, const std::vector<Adesk::UInt8>& valueBlock)
+{
+    pFiler->writeUInt32(static_cast<Adesk::UInt32>(valueBlock.size()));
+    if (!valueBlock.empty())
+        pFiler->writeBytes(valueBlock.data(), valueBlock.size());
+}
+
 Acad::ErrorStatus DbGrasshopperData::dwgOutFields(AcDbDwgFiler* pFiler) const
 {
     assertReadEnabled();
@@ -115,15 +203,28 @@ Acad::ErrorStatus DbGrasshopperData::dwgOutFields(AcDbDwgFiler* pFiler) const
     if (Acad::eOk != status)
         return status;
 
+    // version 1: name table followed by a single packed value block
     pFiler->writeUInt8(CLASS_VERSION);
     pFiler->writeString(m_definition);
     pFiler->writeItem(m_isVisible);
-    pFiler->writeItem(m_props.size());
+    if (!m_lazyNames.empty())
+    {
+        // properties were not touched since loading, pass the payload through
+        pFiler->writeUInt32(static_cast<Adesk::UInt32>(m_lazyNames.size()));
+        for (auto propName : m_lazyNames)
+            pFiler->writeString(propName);
+        writeValueBlock(pFiler, m_lazyValues);
+        return pFiler->filerStatus();
+    }
+
+    pFiler->writeUInt32(static_cast<Adesk::UInt32>(m_props.size()));
+    std::vector<Adesk::UInt8> valueBlock;
     for (const auto& prop : m_props)
     {
-        pFiler->writeString(prop.first);
-        prop.second->dwgOutFields(pFiler);
+        pFiler->writeString(prop.name);
+        prop.value.packValue(valueBlock);
     }
+    writeValueBlock(pFiler, valueBlock);
     return pFiler->filerStatus();
 }
 
@@ -131,6 +232,8 @@ Acad::ErrorStatus DbGrasshopperData::dwgInFields(AcDbDwgFiler* pFiler)
 {
     assertWriteEnabled();
     m_props.clear();
+    m_lazyNames.clear();
+    m_lazyValues.clear();
     Acad::ErrorStatus status = AcDbObject::dwgInFields(pFiler);
     if (Acad::eOk != status)
         return status;
@@ -142,8 +245,53 @@ Acad::ErrorStatus DbGrasshopperData::dwgInFields(AcDbDwgFiler* pFiler)
 
     pFiler->readString(m_definition);
     pFiler->readItem(&m_isVisible);
+    if (version == 0)
+        status = dwgInPropertiesV0(pFiler);
+    else
+        status = dwgInPropertiesV1(pFiler);
+
+    // only a drawing being read registers the object, copy/undo/paging filers re-read objects already indexed
+    if (Acad::eOk == status && pFiler->filerType() == AcDb::kFileFiler && !isErased())
+        GhDataIndex::add(database(), objectId());
+    return status;
+}
+
+Acad::ErrorStatus DbGrasshopperData::dwgInPropertiesV1(AcDbDwgFiler* pFiler)
+{
+    // the value block is only decoded when the properties are first accessed
+    Adesk::UInt32 propSize;
+    pFiler->readUInt32(&propSize);
+    m_lazyNames.resize(propSize);
+    for (auto& propName : m_lazyNames)
+    {
+        AcString name;
+        pFiler->readString(name);
+        propName = GhPropertyTable::intern(name);
+    }
+
+    Adesk::UInt32 blockSize;
+    pFiler->readUInt32(&blockSize);
+    m_lazyValues.resize(blockSize);
+    if (blockSize != 0)
+        pFiler->readBytes(m_lazyValues.data(), blockSize);
+    if (Acad::eOk != pFiler->filerStatus())
+        return pFiler->filerStatus();
+
+    // a damaged block would decode only partially later on, and the next save would drop the rest
+    if (!isValueBlockComplete(m_lazyNames.size(), m_lazyValues))
+    {
+        m_lazyNames.clear();
+        m_lazyValues.clear();
+        return Acad::eDwgObjectImproperlyRead;
+    }
+    return Acad::eOk;
+}
+
+Acad::ErrorStatus DbGrasshopperData::dwgInPropertiesV0(AcDbDwgFiler* pFiler)
+{
     size_t propSize;
     pFiler->readItem(&propSize);
+    m_props.reserve(propSize);
     for (size_t i = 0; i < propSize; ++i)
     {
         AcString propName;
@@ -200,6 +348,7 @@ bool DbGrasshopperData::attachGrasshopperData(AcDbEntity* pEnt, DbGrasshopperDat
     {
         pDict->upgradeOpen();
         pDict->setAt(s_ghData, pData, ghDataId);
+        GhDataIndex::add(pEnt->database(), ghDataId, pEnt->objectId());
         return true;
     }
     return false;
@@ -217,6 +366,7 @@ void DbGrasshopperData::removeGrasshopperData(AcDbEntity* pEnt)
         return;
 
     pDict->remove(ghId);
+    GhDataIndex::remove(pEnt->database(), ghId);
     AcDbObjectPointer<DbGrasshopperData> pGhData(ghId, AcDb::kForWrite);
     if (pGhData.openStatus() == eOk)
         pGhData->erase();
@@ -2,22 +2,26 @@
 
 #include "Export.h"
 #include "GhProperty.h"
+#include "GhPropertyTable.h"
 
-#include <map>
-#include <memory>
 #include <vector>
 
-using GhProperties = std::map<AcString, std::unique_ptr<GhProperty>>;
+using GhProperties = GhPropertyTable;
 using GhPropertyTypeArray = std::vector<std::pair<AcString, GhProperty::Type>>;
+using GhPropertyArray = std::vector<std::pair<AcString, GhProperty>>;
 
 class GH_IMPORTEXPORT DbGrasshopperData : public AcDbObject
 {
 private:
     // stored in DWG
     AcString m_definition;
-    GhProperties m_props;
+    mutable GhProperties m_props;
     bool m_isVisible = false;
 
+    // property payload as read from DWG, decoded into m_props on first access
+    mutable std::vector<const ACHAR*> m_lazyNames;
+    mutable std::vector<Adesk::UInt8> m_lazyValues;
+
 public:
     ACRX_DECLARE_MEMBERS(DbGrasshopperData);
 
@@ -37,6 +41,8 @@ public:
     GhPropertyTypeArray getPropertiesTypes() const;
     GhProperty getProperty(const AcString& name) const;
     bool updateProperty(const AcString& name, const GhProperty& value);
+    void getProperties(const std::vector<AcString>& names, std::vector<GhProperty>& values) const;
+    size_t updateProperties(const GhPropertyArray& values);
     bool addProperty(const AcString& name, const GhProperty& value);
     void clearProperties();
 
@@ -49,6 +55,13 @@ public:
     //AcDbObject
     Acad::ErrorStatus dwgOutFields(AcDbDwgFiler*) const override;
     Acad::ErrorStatus dwgInFields(AcDbDwgFiler*) override;
+
+private:
+    const GhProperties& properties() const;
+    GhProperties& properties();
+    void materializeProperties() const;
+    Acad::ErrorStatus dwgInPropertiesV0(AcDbDwgFiler*);
+    Acad::ErrorStatus dwgInPropertiesV1(AcDbDwgFiler*);
 };
 
 ACDB_REGISTER_OBJECT_ENTRY_AUTO(DbGrasshopperData)
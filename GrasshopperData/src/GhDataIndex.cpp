@@ -0,0 +1,175 @@
+#include "StdAfx.h"
+#include "GhDataIndex.h"
+#include "DbGrasshopperData.h"
+
+#include <map>
+#include <mutex>
+
+namespace
+{
+    // GrasshopperData id -> host entity id, the host is resolved on first query
+    // when it was not known at registration time (e.g. while loading)
+    using HostMap = std::map<AcDbObjectId, AcDbObjectId>;
+
+    std::map<const AcDbDatabase*, HostMap> s_indices;
+    // databases may be read on a worker thread (e.g. by acdbReadDwgFile in a background job)
+    // while the main thread queries; recursive because resolving a host opens objects
+    std::recursive_mutex s_mutex;
+
+    class GhDataDbReactor : public AcDbDatabaseReactor
+    {
+    public:
+        void objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override
+        {
+            if (DbGrasshopperData::cast(pObj))
+                GhDataIndex::add(pDb, pObj->objectId());
+        }
+
+        void objectUnAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override
+        {
+            if (DbGrasshopperData::cast(pObj))
+                GhDataIndex::remove(pDb, pObj->objectId());
+        }
+
+        void objectReAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override
+        {
+            if (DbGrasshopperData::cast(pObj))
+                GhDataIndex::add(pDb, pObj->objectId());
+        }
+
+        void objectErased(const AcDbDatabase* pDb, const AcDbObject* pObj, Adesk::Boolean pErased) override
+        {
+            if (!DbGrasshopperData::cast(pObj))
+                return;
+            if (pErased)
+                GhDataIndex::remove(pDb, pObj->objectId());
+            else
+                GhDataIndex::add(pDb, pObj->objectId());
+        }
+
+        void goodbye(const AcDbDatabase* pDb) override;
+    };
+
+    class GhDataEventReactor : public AcRxEventReactor
+    {
+    public:
+        void databaseConstructed(AcDbDatabase* pDb) override;
+        void databaseToBeDestroyed(AcDbDatabase* pDb) override;
+    };
+
+    GhDataDbReactor* s_dbReactor = nullptr;
+    GhDataEventReactor* s_eventReactor = nullptr;
+
+    HostMap* getIndex(const AcDbDatabase* pDb)
+    {
+        auto i = s_indices.find(pDb);
+        return i == s_indices.end() ? nullptr : &i->second;
+    }
+
+    HostMap& ensureIndex(const AcDbDatabase* pDb)
+    {
+        auto i = s_indices.lower_bound(pDb);
+        if (i != s_indices.end() && i->first == pDb)
+            return i->second;
+
+        if (s_dbReactor)
+            pDb->addReactor(s_dbReactor);
+        return s_indices.emplace_hint(i, pDb, HostMap())->second;
+    }
+
+    void dropIndex(const AcDbDatabase* pDb)
+    {
+        std::lock_guard<std::recursive_mutex> lock(s_mutex);
+        auto i = s_indices.find(pDb);
+        if (i == s_indices.end())
+            return;
+
+        if (s_dbReactor)
+            pDb->removeReactor(s_dbReactor);
+        s_indices.erase(i);
+    }
+
+    void GhDataDbReactor::goodbye(const AcDbDatabase* pDb)
+    {
+        dropIndex(pDb);
+    }
+
+    void GhDataEventReactor::databaseConstructed(AcDbDatabase* pDb)
+    {
+        // watch every new database, so objects cloned into it are seen as well
+        std::lock_guard<std::recursive_mutex> lock(s_mutex);
+        ensureIndex(pDb);
+    }
+
+    void GhDataEventReactor::databaseToBeDestroyed(AcDbDatabase* pDb)
+    {
+        dropIndex(pDb);
+    }
+}
+
+void GhDataIndex::add(const AcDbDatabase* pDb, const AcDbObjectId& ghDataId, const AcDbObjectId& hostId)
+{
+    if (!pDb || ghDataId.isNull())
+        return;
+
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    auto& index = ensureIndex(pDb);
+    auto& host = index[ghDataId];
+    if (!hostId.isNull())
+        host = hostId;
+}
+
+void GhDataIndex::remove(const AcDbDatabase* pDb, const AcDbObjectId& ghDataId)
+{
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    if (auto pIndex = getIndex(pDb))
+        pIndex->erase(ghDataId);
+}
+
+void GhDataIndex::getGrasshopperData(const AcDbDatabase* pDb, AcDbObjectIdArray& hostIds, AcDbObjectIdArray& ghDataIds)
+{
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    auto pIndex = getIndex(pDb);
+    if (!pIndex)
+        return;
+
+    for (auto& entry : *pIndex)
+    {
+        if (entry.second.isNull())
+        {
+            AcDbObjectPointer<DbGrasshopperData> pGhData(entry.first, AcDb::kForRead);
+            if (pGhData.openStatus() == eOk)
+                entry.second = pGhData->getHostEntity();
+        }
+        hostIds.append(entry.second);
+        ghDataIds.append(entry.first);
+    }
+}
+
+size_t GhDataIndex::size(const AcDbDatabase* pDb)
+{
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    auto pIndex = getIndex(pDb);
+    return pIndex ? pIndex->size() : 0;
+}
+
+bool registerGhDataIndex()
+{
+    s_dbReactor = new GhDataDbReactor();
+    s_eventReactor = new GhDataEventReactor();
+    acrxEvent->addReactor(s_eventReactor);
+    return true;
+}
+
+bool unregisterGhDataIndex()
+{
+    if (s_eventReactor)
+        acrxEvent->removeReactor(s_eventReactor);
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    for (auto& index : s_indices)
+        index.first->removeReactor(s_dbReactor);
+    s_indices.clear();
+    delete s_eventReactor, s_eventReactor = nullptr;
+    delete s_dbReactor, s_dbReactor = nullptr;
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Export.h"
+
+// Per-database index of DbGrasshopperData objects and the entities hosting them.
+// It is filled while a drawing loads and kept current from attach/remove and
+// from database notifications, so callers never need to walk the block table
+// to find the parametric entities of a drawing.
+class GH_IMPORTEXPORT GhDataIndex
+{
+public:
+    static void add(const AcDbDatabase* pDb, const AcDbObjectId& ghDataId,
+                    const AcDbObjectId& hostId = AcDbObjectId::kNull);
+    static void remove(const AcDbDatabase* pDb, const AcDbObjectId& ghDataId);
+
+    // fills parallel arrays of host entity ids and their GrasshopperData ids
+    static void getGrasshopperData(const AcDbDatabase* pDb,
+                                   AcDbObjectIdArray& hostIds,
+                                   AcDbObjectIdArray& ghDataIds);
+    static size_t size(const AcDbDatabase* pDb);
+};
+
+bool registerGhDataIndex();
+bool unregisterGhDataIndex();
@@ -0,0 +1,341 @@
+#include "StdAfx.h"
+#include "GhDataTests.h"
+
+#ifdef _DEBUG
+#include "DbGrasshopperData.h"
+#include "GhProperty.h"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Stand-in filer keeping everything written in a byte buffer, read back from the start after rewind().
+    // Ids are stored as they are, so it only round trips within the session.
+    class MemoryFiler : public AcDbDwgFiler
+    {
+    public:
+        explicit MemoryFiler(AcDb::FilerType type = AcDb::kCopyFiler) : m_type(type) {}
+
+        void rewind() { m_pos = 0; m_status = Acad::eOk; }
+        const std::vector<Adesk::UInt8>& buffer() const { return m_buffer; }
+
+        Acad::ErrorStatus filerStatus() const override { return m_status; }
+        AcDb::FilerType filerType() const override { return m_type; }
+        void setFilerStatus(Acad::ErrorStatus status) override { m_status = status; }
+        void resetFilerStatus() override { m_status = Acad::eOk; }
+
+        Acad::ErrorStatus readHardOwnershipId(AcDbHardOwnershipId* pId) override { return read(pId); }
+        Acad::ErrorStatus writeHardOwnershipId(const AcDbHardOwnershipId& id) override { return write(id); }
+        Acad::ErrorStatus readSoftOwnershipId(AcDbSoftOwnershipId* pId) override { return read(pId); }
+        Acad::ErrorStatus writeSoftOwnershipId(const AcDbSoftOwnershipId& id) override { return write(id); }
+        Acad::ErrorStatus readHardPointerId(AcDbHardPointerId* pId) override { return read(pId); }
+        Acad::ErrorStatus writeHardPointerId(const AcDbHardPointerId& id) override { return write(id); }
+        Acad::ErrorStatus readSoftPointerId(AcDbSoftPointerId* pId) override { return read(pId); }
+        Acad::ErrorStatus writeSoftPointerId(const AcDbSoftPointerId& id) override { return write(id); }
+
+        Acad::ErrorStatus readString(ACHAR** ppStr) override
+        {
+            AcString str;
+            readString(str);
+            *ppStr = nullptr;
+            return m_status == Acad::eOk ? acutNewString(str.constPtr(), *ppStr) : m_status;
+        }
+        Acad::ErrorStatus writeString(const ACHAR* pStr) override
+        {
+            Adesk::UInt32 length = pStr ? static_cast<Adesk::UInt32>(wcslen(pStr)) : 0;
+            write(length);
+            return writeBytes(pStr, length * sizeof(ACHAR));
+        }
+        Acad::ErrorStatus readString(AcString& str) override
+        {
+            Adesk::UInt32 length = 0;
+            if (read(&length) != Acad::eOk || (m_buffer.size() - m_pos) / sizeof(ACHAR) < length)
+                return fail();
+            std::vector<ACHAR> chars(length + 1, 0);
+            readBytes(chars.data(), length * sizeof(ACHAR));
+            str = chars.data();
+            return m_status;
+        }
+        Acad::ErrorStatus writeString(const AcString& str) override { return writeString(str.constPtr()); }
+
+        Acad::ErrorStatus readBChunk(ads_binary* pChunk) override
+        {
+            pChunk->buf = nullptr;
+            if (read(&pChunk->clen) != Acad::eOk || pChunk->clen < 0)
+                return fail();
+            pChunk->buf = new char[pChunk->clen];
+            return readBytes(pChunk->buf, pChunk->clen);
+        }
+        Acad::ErrorStatus writeBChunk(const ads_binary& chunk) override
+        {
+            write(chunk.clen);
+            return writeBytes(chunk.buf, chunk.clen);
+        }
+
+        Acad::ErrorStatus readAcDbHandle(AcDbHandle* pHandle) override { return read(pHandle); }
+        Acad::ErrorStatus writeAcDbHandle(const AcDbHandle& handle) override { return write(handle); }
+        Acad::ErrorStatus readInt64(Adesk::Int64* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeInt64(Adesk::Int64 val) override { return write(val); }
+        Acad::ErrorStatus readInt32(Adesk::Int32* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeInt32(Adesk::Int32 val) override { return write(val); }
+        Acad::ErrorStatus readInt16(Adesk::Int16* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeInt16(Adesk::Int16 val) override { return write(val); }
+        Acad::ErrorStatus readInt8(Adesk::Int8* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeInt8(Adesk::Int8 val) override { return write(val); }
+        Acad::ErrorStatus readUInt64(Adesk::UInt64* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeUInt64(Adesk::UInt64 val) override { return write(val); }
+        Acad::ErrorStatus readUInt32(Adesk::UInt32* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeUInt32(Adesk::UInt32 val) override { return write(val); }
+        Acad::ErrorStatus readUInt16(Adesk::UInt16* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeUInt16(Adesk::UInt16 val) override { return write(val); }
+        Acad::ErrorStatus readUInt8(Adesk::UInt8* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeUInt8(Adesk::UInt8 val) override { return write(val); }
+        Acad::ErrorStatus readBoolean(Adesk::Boolean* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeBoolean(Adesk::Boolean val) override { return write(val); }
+        Acad::ErrorStatus readBool(bool* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeBool(bool val) override { return write(val); }
+        Acad::ErrorStatus readDouble(double* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeDouble(double val) override { return write(val); }
+        Acad::ErrorStatus readPoint2d(AcGePoint2d* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writePoint2d(const AcGePoint2d& val) override { return write(val); }
+        Acad::ErrorStatus readPoint3d(AcGePoint3d* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writePoint3d(const AcGePoint3d& val) override { return write(val); }
+        Acad::ErrorStatus readVector2d(AcGeVector2d* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeVector2d(const AcGeVector2d& val) override { return write(val); }
+        Acad::ErrorStatus readVector3d(AcGeVector3d* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeVector3d(const AcGeVector3d& val) override { return write(val); }
+        Acad::ErrorStatus readScale3d(AcGeScale3d* pVal) override { return read(pVal); }
+        Acad::ErrorStatus writeScale3d(const AcGeScale3d& val) override { return write(val); }
+
+        Acad::ErrorStatus readBytes(void* pDest, Adesk::UIntPtr size) override
+        {
+            if (m_status != Acad::eOk || m_buffer.size() - m_pos < size)
+                return fail();
+            if (size != 0)
+                memcpy(pDest, m_buffer.data() + m_pos, size);
+            m_pos += size;
+            return Acad::eOk;
+        }
+        Acad::ErrorStatus writeBytes(const void* pSrc, Adesk::UIntPtr size) override
+        {
+            auto pBytes = static_cast<const Adesk::UInt8*>(pSrc);
+            m_buffer.insert(m_buffer.end(), pBytes, pBytes + size);
+            return Acad::eOk;
+        }
+        Acad::ErrorStatus readAddress(void** ppVal) override { return read(ppVal); }
+        Acad::ErrorStatus writeAddress(const void* pVal) override { return write(pVal); }
+
+        Acad::ErrorStatus seek(Adesk::Int64 offset, int method) override
+        {
+            Adesk::Int64 base = method == AcDb::kSeekFromStart ? 0 :
+                                method == AcDb::kSeekFromCurrent ? static_cast<Adesk::Int64>(m_pos) :
+                                static_cast<Adesk::Int64>(m_buffer.size());
+            if (base + offset < 0 || base + offset > static_cast<Adesk::Int64>(m_buffer.size()))
+                return fail();
+            m_pos = static_cast<size_t>(base + offset);
+            return Acad::eOk;
+        }
+        Adesk::Int64 tell() const override { return static_cast<Adesk::Int64>(m_pos); }
+
+    private:
+        template <typename T>
+        Acad::ErrorStatus read(T* pVal) { return readBytes(pVal, sizeof(T)); }
+        template <typename T>
+        Acad::ErrorStatus write(const T& val) { return writeBytes(&val, sizeof(T)); }
+        Acad::ErrorStatus fail()
+        {
+            if (m_status == Acad::eOk)
+                m_status = Acad::eEndOfFile;
+            return m_status;
+        }
+
+        std::vector<Adesk::UInt8> m_buffer;
+        size_t m_pos = 0;
+        Acad::ErrorStatus m_status = Acad::eOk;
+        AcDb::FilerType m_type;
+    };
+
+    struct TestProperty
+    {
+        const ACHAR* name;
+        GhProperty value;
+    };
+
+    std::vector<TestProperty> testProperties()
+    {
+        return {
+            { L"Bool", GhProperty(true) },
+            { L"Int", GhProperty(-42) },
+            { L"Real", GhProperty(1.0e-300) },
+            { L"NaN", GhProperty(std::numeric_limits<double>::quiet_NaN()) },
+            { L"Short", GhProperty(AcString(L"abc")) },
+            { L"Long", GhProperty(AcString(L"a string too long to be kept inside the property")) },
+            { L"Empty", GhProperty(AcString(L"")) },
+            { L"Point", GhProperty(AcGePoint3d(1.0, -2.5, 3.0)) },
+            { L"Vector", GhProperty(AcGeVector3d(0.0, 0.0, -1.0)) },
+            { L"Unset", GhProperty(GhProperty::eReal) }
+        };
+    }
+
+    bool sameReal(double a, double b)
+    {
+        return (std::isnan(a) && std::isnan(b)) || a == b;
+    }
+
+    bool sameValue(const GhProperty& expected, const GhProperty& actual)
+    {
+        if (expected.getType() != actual.getType() || expected.isSet() != actual.isSet())
+            return false;
+        if (!expected.isSet())
+            return true;
+
+        switch (expected.getType())
+        {
+        case GhProperty::eInt:
+        {
+            int a = 0, b = 0;
+            return expected.getValue(a) && actual.getValue(b) && a == b;
+        }
+        case GhProperty::eReal:
+        {
+            double a = 0.0, b = 0.0;
+            return expected.getValue(a) && actual.getValue(b) && sameReal(a, b);
+        }
+        case GhProperty::eBool:
+        {
+            bool a = false, b = false;
+            return expected.getValue(a) && actual.getValue(b) && a == b;
+        }
+        case GhProperty::eString:
+        {
+            AcString a, b;
+            return expected.getValue(a) && actual.getValue(b) && a == b;
+        }
+        case GhProperty::ePoint:
+        {
+            AcGePoint3d a, b;
+            return expected.getValue(a) && actual.getValue(b) && a.x == b.x && a.y == b.y && a.z == b.z;
+        }
+        case GhProperty::eVector:
+        {
+            AcGeVector3d a, b;
+            return expected.getValue(a) && actual.getValue(b) && a.x == b.x && a.y == b.y && a.z == b.z;
+        }
+        default:
+            return true;
+        }
+    }
+
+    bool check(bool condition, const ACHAR* test, const ACHAR* what)
+    {
+        if (!condition)
+            acutPrintf(_T("\n%s: %s failed"), test, what);
+        return condition;
+    }
+
+    bool checkProperties(const DbGrasshopperData& ghData, const ACHAR* test)
+    {
+        bool res = true;
+        for (const auto& prop : testProperties())
+            res &= check(sameValue(prop.value, ghData.getProperty(prop.name)), test, prop.name);
+        res &= check(ghData.getPropertiesTypes().size() == testProperties().size(), test, _T("property count"));
+        res &= check(ghData.getDefinition() == AcString(L"box.gh"), test, _T("definition"));
+        res &= check(ghData.getVisibility(), test, _T("visibility"));
+        return res;
+    }
+
+    // v1: written by dwgOutFields, read back, and written again unchanged before and after decoding
+    bool testV1RoundTrip()
+    {
+        const ACHAR* test = _T("v1 round trip");
+        DbGrasshopperData written(L"box.gh");
+        written.setVisibility(true);
+        for (const auto& prop : testProperties())
+            written.addProperty(prop.name, prop.value);
+
+        MemoryFiler filer;
+        if (!check(written.dwgOutFields(&filer) == Acad::eOk, test, _T("dwgOutFields")))
+            return false;
+        filer.rewind();
+        DbGrasshopperData read;
+        if (!check(read.dwgInFields(&filer) == Acad::eOk, test, _T("dwgInFields")))
+            return false;
+
+        MemoryFiler passThrough;
+        read.dwgOutFields(&passThrough);
+        bool res = check(passThrough.buffer() == filer.buffer(), test, _T("save before decoding"));
+        res &= checkProperties(read, test);
+        MemoryFiler decoded;
+        read.dwgOutFields(&decoded);
+        res &= check(decoded.buffer() == filer.buffer(), test, _T("save after decoding"));
+        return res;
+    }
+
+    // v0: the layout of previous releases, written field by field, read and saved again as v1
+    bool testV0Upgrade()
+    {
+        const ACHAR* test = _T("v0 upgrade");
+        DbGrasshopperData base;
+        MemoryFiler filer;
+        base.AcDbObject::dwgOutFields(&filer);
+        filer.writeUInt8(0);
+        filer.writeString(L"box.gh");
+        filer.writeItem(true);
+        const auto props = testProperties();
+        filer.writeItem(props.size());
+        for (const auto& prop : props)
+        {
+            filer.writeString(prop.name);
+            prop.value.dwgOutFields(&filer);
+        }
+
+        filer.rewind();
+        DbGrasshopperData read;
+        if (!check(read.dwgInFields(&filer) == Acad::eOk, test, _T("dwgInFields")))
+            return false;
+        bool res = checkProperties(read, test);
+
+        MemoryFiler saved;
+        read.dwgOutFields(&saved);
+        saved.rewind();
+        DbGrasshopperData reread;
+        res &= check(reread.dwgInFields(&saved) == Acad::eOk, test, _T("reading the v1 save"));
+        return res && checkProperties(reread, test);
+    }
+
+    // a value block cut short must be rejected, not decoded partially
+    bool testTruncatedBlock()
+    {
+        const ACHAR* test = _T("truncated value block");
+        std::vector<Adesk::UInt8> valueBlock;
+        GhProperty(AcGePoint3d(1.0, 2.0, 3.0)).packValue(valueBlock);
+        valueBlock.pop_back();
+
+        DbGrasshopperData base;
+        MemoryFiler filer;
+        base.AcDbObject::dwgOutFields(&filer);
+        filer.writeUInt8(1);
+        filer.writeString(L"box.gh");
+        filer.writeItem(true);
+        filer.writeUInt32(1);
+        filer.writeString(L"Point");
+        filer.writeUInt32(static_cast<Adesk::UInt32>(valueBlock.size()));
+        filer.writeBytes(valueBlock.data(), valueBlock.size());
+
+        filer.rewind();
+        DbGrasshopperData read;
+        bool res = check(read.dwgInFields(&filer) == Acad::eDwgObjectImproperlyRead, test, _T("rejection"));
+        return res && check(read.getPropertiesTypes().empty(), test, _T("partial properties"));
+    }
+}
+
+bool runGhDataTests()
+{
+    bool res = testV1RoundTrip();
+    res &= testV0Upgrade();
+    res &= testTruncatedBlock();
+    acutPrintf(res ? _T("\nGhDataApp tests passed") : _T("\nGhDataApp tests failed"));
+    return res;
+}
+#endif
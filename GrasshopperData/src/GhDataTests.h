@@ -0,0 +1,7 @@
+#pragma once
+
+#ifdef _DEBUG
+// Round trips of DbGrasshopperData through an in-memory filer, for the v0 (per property fields)
+// and v1 (name table and packed value block) layouts. Prints each failure, true if all passed.
+bool runGhDataTests();
+#endif
@@ -29,236 +29,494 @@ struct TypeInfo<DataType>\
 TYPE_MAP()
 #undef MAP_ENTRY
 
-template<typename AType>
-struct ByValue
+// The value block is little-endian and strings are UTF-16 code units, so drawings
+// read the same whatever the width of ACHAR and the byte order of the host.
+static void packBytes(std::vector<Adesk::UInt8>& buffer, Adesk::UInt64 value, size_t size)
 {
-    using ArgumentType = AType;
-};
+    for (size_t i = 0; i < size; ++i)
+        buffer.push_back(static_cast<Adesk::UInt8>(value >> (8 * i)));
+}
 
-template<typename AType>
-struct ByRef
+static bool unpackBytes(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd, Adesk::UInt64& value, size_t size)
 {
-    using ArgumentType = AType const&;
-};
-
-template<typename AType, typename Enable = void>
-struct DataTraits : ByRef<AType> {};
+    if (static_cast<size_t>(pEnd - pData) < size)
+        return false;
+    value = 0;
+    for (size_t i = 0; i < size; ++i)
+        value |= static_cast<Adesk::UInt64>(pData[i]) << (8 * i);
+    pData += size;
+    return true;
+}
 
-template<typename AType>
-struct DataTraits<AType, typename std::enable_if<std::is_fundamental<AType>::value, void>::type> : ByValue<AType> {};
+static void pack(std::vector<Adesk::UInt8>& buffer, Adesk::UInt8 v) { packBytes(buffer, v, sizeof(v)); }
+static void pack(std::vector<Adesk::UInt8>& buffer, Adesk::UInt16 v) { packBytes(buffer, v, sizeof(v)); }
+static void pack(std::vector<Adesk::UInt8>& buffer, Adesk::UInt32 v) { packBytes(buffer, v, sizeof(v)); }
 
-class PropertyDataBase
+static void pack(std::vector<Adesk::UInt8>& buffer, double v)
 {
-public:
-    virtual ~PropertyDataBase() = default;
-    static PropertyDataBase* create(GhProperty::Type);
-
-    virtual PropertyDataBase* clone() const = 0;
-    virtual void dwgOutFields(AcDbDwgFiler* pFiler) const = 0;
-    virtual void dwgInFields(AcDbDwgFiler* pFiler) = 0;
-};
+    Adesk::UInt64 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    packBytes(buffer, bits, sizeof(bits));
+}
 
 template <typename T>
-class PropertyData : public PropertyDataBase
+static bool unpack(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd, T& value)
 {
-public:
-    PropertyData() = default;
-    PropertyData(typename DataTraits<T>::ArgumentType data) : m_data(data) {}
-    ~PropertyData() = default;
-
-    typename DataTraits<T>::ArgumentType getData() const
-    {
-        return m_data;
-    }
-
-    void setData(typename DataTraits<T>::ArgumentType data)
-    {
-        m_data = data;
-    }
+    Adesk::UInt64 bits;
+    if (!unpackBytes(pData, pEnd, bits, sizeof(T)))
+        return false;
+    value = static_cast<T>(bits);
+    return true;
+}
 
-    PropertyDataBase* clone() const
-    {
-        return new PropertyData(m_data);
-    }
+template <>
+bool unpack(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd, double& value)
+{
+    Adesk::UInt64 bits;
+    if (!unpackBytes(pData, pEnd, bits, sizeof(bits)))
+        return false;
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
 
-    void dwgOutFields(AcDbDwgFiler* pFiler) const override
+static void packString(std::vector<Adesk::UInt8>& buffer, const ACHAR* str, Adesk::UInt32 length)
+{
+    std::vector<Adesk::UInt16> units;
+    units.reserve(length);
+    for (Adesk::UInt32 i = 0; i < length; ++i)
     {
-        pFiler->writeItem(m_data);
+        auto c = static_cast<Adesk::UInt32>(str[i]);
+        if (c > 0xFFFF)
+        {
+            // only reached with a 32-bit ACHAR, store a surrogate pair
+            c -= 0x10000;
+            units.push_back(static_cast<Adesk::UInt16>(0xD800 | (c >> 10)));
+            units.push_back(static_cast<Adesk::UInt16>(0xDC00 | (c & 0x3FF)));
+        }
+        else
+            units.push_back(static_cast<Adesk::UInt16>(c));
     }
+    pack(buffer, static_cast<Adesk::UInt32>(units.size()));
+    for (auto unit : units)
+        pack(buffer, unit);
+}
 
-    void dwgInFields(AcDbDwgFiler* pFiler) override
+static bool unpackString(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd, std::vector<ACHAR>& chars)
+{
+    constexpr bool kWideAchar = sizeof(ACHAR) > sizeof(Adesk::UInt16);
+    Adesk::UInt32 count;
+    if (!unpack(pData, pEnd, count) || static_cast<size_t>(pEnd - pData) / sizeof(Adesk::UInt16) < count)
+        return false;
+
+    chars.clear();
+    chars.reserve(count);
+    for (Adesk::UInt32 i = 0; i < count; ++i)
     {
-        pFiler->readItem(&m_data);
+        Adesk::UInt16 unit;
+        unpack(pData, pEnd, unit);
+        if (kWideAchar && unit >= 0xD800 && unit < 0xDC00 && i + 1 < count)
+        {
+            const Adesk::UInt8* pNext = pData;
+            Adesk::UInt16 low;
+            unpack(pNext, pEnd, low);
+            if (low >= 0xDC00 && low < 0xE000)
+            {
+                pData = pNext;
+                ++i;
+                chars.push_back(static_cast<ACHAR>(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00)));
+                continue;
+            }
+        }
+        chars.push_back(static_cast<ACHAR>(unit));
     }
-
-private:
-    T m_data;
-};
-
-void PropertyData<AcString>::dwgInFields(AcDbDwgFiler* pFiler)
-{
-    pFiler->readString(m_data);
+    return true;
 }
 
-void PropertyData<int>::dwgInFields(AcDbDwgFiler* pFiler)
+template <>
+void GhProperty::getData(int& v) const { v = m_data.m_int; }
+template <>
+void GhProperty::getData(double& v) const { v = m_data.m_real; }
+template <>
+void GhProperty::getData(bool& v) const { v = m_data.m_bool; }
+template <>
+void GhProperty::getData(AcString& v) const { v = chars(); }
+template <>
+void GhProperty::getData(AcGePoint3d& v) const { v.set(m_data.m_xyz[0], m_data.m_xyz[1], m_data.m_xyz[2]); }
+template <>
+void GhProperty::getData(AcGeVector3d& v) const { v.set(m_data.m_xyz[0], m_data.m_xyz[1], m_data.m_xyz[2]); }
+
+template <>
+void GhProperty::setData(const int& v) { m_data.m_int = v; }
+template <>
+void GhProperty::setData(const double& v) { m_data.m_real = v; }
+template <>
+void GhProperty::setData(const bool& v) { m_data.m_bool = v; }
+template <>
+void GhProperty::setData(const AcString& v) { assignString(v.constPtr(), v.length()); }
+
+template <>
+void GhProperty::setData(const AcGePoint3d& v)
 {
-    pFiler->readInt32((Adesk::Int32*)&m_data);
+    m_data.m_xyz[0] = v.x;
+    m_data.m_xyz[1] = v.y;
+    m_data.m_xyz[2] = v.z;
 }
 
-void PropertyData<int>::dwgOutFields(AcDbDwgFiler* pFiler) const
+template <>
+void GhProperty::setData(const AcGeVector3d& v)
 {
-    pFiler->writeInt32(m_data);
+    m_data.m_xyz[0] = v.x;
+    m_data.m_xyz[1] = v.y;
+    m_data.m_xyz[2] = v.z;
 }
 
-PropertyDataBase* PropertyDataBase::create(GhProperty::Type type)
+template <typename T>
+bool GhProperty::getValueImpl(T& val) const
 {
-    switch (type)
-    {
-#define MAP_ENTRY(DataType, TypeId)\
-    case GhProperty::TypeId: return new PropertyData<DataType>();
-        TYPE_MAP()
-#undef MAP_ENTRY
-    }
-    return nullptr;
+    if (m_type != TypeInfo<T>::Value)
+        return false;
+    getData(val);
+    return true;
 }
 
-class GhProperty::Impl
+template <typename T>
+bool GhProperty::setValueImpl(const T& val)
 {
-public:
-    Impl(GhProperty::Type type) : m_type(type), m_data(PropertyDataBase::create(type))
-    {}
-    
-    ~Impl()
-    {
-        if (m_data)
-            delete m_data;
-    }
-
-    Impl* clone()
-    {        
-        return new Impl(m_type, m_data ? m_data->clone() : nullptr, m_isSet);
-    }
-
-    template <typename T>
-    bool setValue(typename DataTraits<T>::ArgumentType val)
-    {
-        if (!m_data || m_type != TypeInfo<T>::Value)
-            return false;
-
-        m_isSet = true;
-        static_cast<PropertyData<T>*>(m_data)->setData(val);
-        return true;
-    }
-    
-    template <typename T>
-    bool getValue(T& val) const
-    {
-        if (!m_isSet && !m_data || m_type != TypeInfo<T>::Value)
-            return false;
-        val = static_cast<PropertyData<T>*>(m_data)->getData();
-        return true;
-    }
-
-    bool isSet() const
-    {
-        return m_isSet;
-    }
-
-    Acad::ErrorStatus dwgOutFields(AcDbDwgFiler* pFiler) const
-    {
-        pFiler->writeUInt8(m_type);
-        pFiler->writeItem(m_isSet);
-        if (m_isSet)
-            m_data->dwgOutFields(pFiler);
-        return Acad::ErrorStatus::eOk;
-    }
-
-    Acad::ErrorStatus dwgInFields(AcDbDwgFiler* pFiler)
-    {
-        if (m_data)
-            delete m_data;
-
-        m_type = [&]() {
-            Adesk::UInt8 type;
-            pFiler->readUInt8(&type);
-            return static_cast<GhProperty::Type>(type);
-        }();
-        pFiler->readItem(&m_isSet);
-        m_data = PropertyDataBase::create(m_type);
-        if (m_isSet)
-            m_data->dwgInFields(pFiler);
-        return Acad::ErrorStatus::eOk;
-    }
-
-private:
-    Impl(GhProperty::Type type, PropertyDataBase* data, bool isSet) : m_type(type), m_data(data), m_isSet(isSet)
-    {}
-
-    PropertyDataBase* m_data = nullptr;
-    GhProperty::Type m_type = eEmpty;
-    bool m_isSet = false;
-    friend GhProperty;
-};
+    if (m_type != TypeInfo<T>::Value)
+        return false;
+    setData(val);
+    m_isSet = true;
+    return true;
+}
 
 #define ON_PRIMITIVE(DataType)\
-GhProperty::GhProperty(DataType v) : m_pImpl(new Impl(TypeInfo<DataType>::Value))\
+GhProperty::GhProperty(DataType v)\
 {\
-    m_pImpl->setValue<DataType>(v);\
+    reset(TypeInfo<DataType>::Value);\
+    setValueImpl(v);\
 }\
-bool GhProperty::getValue(DataType& v) const { return m_pImpl->getValue(v); }\
-bool GhProperty::setValue(DataType v) { return m_pImpl->setValue<DataType>(v); }
+bool GhProperty::getValue(DataType& v) const { return getValueImpl(v); }\
+bool GhProperty::setValue(DataType v) { return setValueImpl(v); }
 #define ON_COMPLEX(DataType)\
-GhProperty::GhProperty(const DataType& v) : m_pImpl(new Impl(TypeInfo<DataType>::Value))\
+GhProperty::GhProperty(const DataType& v)\
 {\
-    m_pImpl->setValue<DataType>(v);\
+    reset(TypeInfo<DataType>::Value);\
+    setValueImpl(v);\
 }\
-bool GhProperty::getValue(DataType& v) const { return m_pImpl->getValue(v); }\
-bool GhProperty::setValue(const DataType& v) { return m_pImpl->setValue<DataType>(v); }
+bool GhProperty::getValue(DataType& v) const { return getValueImpl(v); }\
+bool GhProperty::setValue(const DataType& v) { return setValueImpl(v); }
 SUPPORTED_TYPES()
 #undef ON_PRIMITIVE
 #undef ON_COMPLEX
 
+const ACHAR* GhProperty::chars() const
+{
+    return isHeapString() ? m_data.m_pChars : m_data.m_chars;
+}
+
+bool GhProperty::isHeapString() const
+{
+    return m_type == eString && m_length >= kInlineLength;
+}
+
+void GhProperty::assignString(const ACHAR* str, Adesk::UInt32 length)
+{
+    if (isHeapString())
+        delete[] m_data.m_pChars;
+
+    m_length = length;
+    ACHAR* pDest = m_data.m_chars;
+    if (isHeapString())
+        pDest = m_data.m_pChars = new ACHAR[length + 1];
+    if (length != 0)
+        memcpy(pDest, str, length * sizeof(ACHAR));
+    pDest[length] = 0;
+}
+
+void GhProperty::copyFrom(const GhProperty& other)
+{
+    reset(other.m_type);
+    if (m_type == eString)
+        assignString(other.chars(), other.m_length);
+    else
+        m_data = other.m_data;
+    m_isSet = other.m_isSet;
+}
+
+void GhProperty::moveFrom(GhProperty& other)
+{
+    reset(eEmpty);
+    m_data = other.m_data;
+    m_length = other.m_length;
+    m_type = other.m_type;
+    m_isSet = other.m_isSet;
+    // the heap buffer, if any, now belongs to this property
+    other.m_type = eEmpty;
+    other.m_length = 0;
+    other.m_isSet = false;
+}
+
+void GhProperty::reset(Type type)
+{
+    if (isHeapString())
+        delete[] m_data.m_pChars;
+
+    memset(&m_data, 0, sizeof(m_data));
+    m_length = 0;
+    m_type = type;
+    m_isSet = false;
+}
+
 GhProperty::Type GhProperty::getType() const
 {
-    return m_pImpl->m_type;
+    return m_type;
 }
 
 bool GhProperty::isSet() const
 {
-    return !isEmpty() && m_pImpl->isSet();
+    return !isEmpty() && m_isSet;
 }
 
 bool GhProperty::isEmpty() const
 {
-    return m_pImpl->m_type == eEmpty;
+    return m_type == eEmpty;
 }
 
-GhProperty::GhProperty() : m_pImpl(std::make_unique<Impl>(eEmpty))
-{}
+GhProperty::GhProperty()
+{
+    reset(eEmpty);
+}
 
-GhProperty::GhProperty(Type type) : m_pImpl(std::make_unique<Impl>(type))
-{}
+GhProperty::GhProperty(Type type)
+{
+    reset(type);
+}
 
 GhProperty::GhProperty(const GhProperty& other)
 {
-    m_pImpl.reset(other.m_pImpl->clone());
+    copyFrom(other);
+}
+
+GhProperty::GhProperty(GhProperty&& other) noexcept
+{
+    moveFrom(other);
 }
 
 GhProperty& GhProperty::operator=(const GhProperty& other)
 {
-    m_pImpl.reset(other.m_pImpl->clone());
+    if (this != &other)
+        copyFrom(other);
+    return *this;
+}
+
+GhProperty& GhProperty::operator=(GhProperty&& other) noexcept
+{
+    if (this != &other)
+        moveFrom(other);
     return *this;
 }
 
 GhProperty::~GhProperty()
-{}
+{
+    reset(eEmpty);
+}
 
 Acad::ErrorStatus GhProperty::dwgOutFields(AcDbDwgFiler* pFiler) const
 {
-    return m_pImpl->dwgOutFields(pFiler);
+    pFiler->writeUInt8(m_type);
+    pFiler->writeItem(m_isSet);
+    if (!m_isSet)
+        return Acad::ErrorStatus::eOk;
+
+    switch (m_type)
+    {
+    case eInt:
+        pFiler->writeInt32(m_data.m_int);
+        break;
+    case eReal:
+        pFiler->writeItem(m_data.m_real);
+        break;
+    case eBool:
+        pFiler->writeItem(m_data.m_bool);
+        break;
+    case eString:
+        pFiler->writeString(chars());
+        break;
+    case ePoint:
+        pFiler->writeItem(AcGePoint3d(m_data.m_xyz[0], m_data.m_xyz[1], m_data.m_xyz[2]));
+        break;
+    case eVector:
+        pFiler->writeItem(AcGeVector3d(m_data.m_xyz[0], m_data.m_xyz[1], m_data.m_xyz[2]));
+        break;
+    }
+    return Acad::ErrorStatus::eOk;
 }
 
 Acad::ErrorStatus GhProperty::dwgInFields(AcDbDwgFiler* pFiler)
 {
-    return m_pImpl->dwgInFields(pFiler);
+    Adesk::UInt8 type;
+    pFiler->readUInt8(&type);
+    reset(static_cast<GhProperty::Type>(type));
+
+    bool isSet = false;
+    pFiler->readItem(&isSet);
+    if (!isSet)
+        return Acad::ErrorStatus::eOk;
+
+    switch (m_type)
+    {
+    case eInt:
+        pFiler->readInt32((Adesk::Int32*)&m_data.m_int);
+        break;
+    case eReal:
+        pFiler->readItem(&m_data.m_real);
+        break;
+    case eBool:
+        pFiler->readItem(&m_data.m_bool);
+        break;
+    case eString:
+    {
+        AcString str;
+        pFiler->readString(str);
+        setData(str);
+        break;
+    }
+    case ePoint:
+    {
+        AcGePoint3d pnt;
+        pFiler->readItem(&pnt);
+        setData(pnt);
+        break;
+    }
+    case eVector:
+    {
+        AcGeVector3d vec;
+        pFiler->readItem(&vec);
+        setData(vec);
+        break;
+    }
+    }
+    m_isSet = !isEmpty();
+    return Acad::ErrorStatus::eOk;
+}
+
+void GhProperty::packValue(std::vector<Adesk::UInt8>& buffer) const
+{
+    pack(buffer, static_cast<Adesk::UInt8>(m_type));
+    pack(buffer, static_cast<Adesk::UInt8>(m_isSet));
+    if (!m_isSet)
+        return;
+
+    switch (m_type)
+    {
+    case eInt:
+        pack(buffer, static_cast<Adesk::UInt32>(m_data.m_int));
+        break;
+    case eReal:
+        pack(buffer, m_data.m_real);
+        break;
+    case eBool:
+        pack(buffer, static_cast<Adesk::UInt8>(m_data.m_bool));
+        break;
+    case eString:
+        packString(buffer, chars(), m_length);
+        break;
+    case ePoint:
+    case eVector:
+        for (double v : m_data.m_xyz)
+            pack(buffer, v);
+        break;
+    }
+}
+
+bool GhProperty::skipValue(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd)
+{
+    Adesk::UInt8 type, isSet;
+    if (!unpack(pData, pEnd, type) || !unpack(pData, pEnd, isSet) || type > eVector)
+        return false;
+    if (!isSet)
+        return true;
+
+    size_t size = 0;
+    switch (type)
+    {
+    case eInt:
+        size = sizeof(Adesk::UInt32);
+        break;
+    case eReal:
+        size = sizeof(double);
+        break;
+    case eBool:
+        size = sizeof(Adesk::UInt8);
+        break;
+    case eString:
+    {
+        Adesk::UInt32 count;
+        if (!unpack(pData, pEnd, count))
+            return false;
+        size = count * sizeof(Adesk::UInt16);
+        break;
+    }
+    case ePoint:
+    case eVector:
+        size = 3 * sizeof(double);
+        break;
+    }
+    if (static_cast<size_t>(pEnd - pData) < size)
+        return false;
+    pData += size;
+    return true;
+}
+
+bool GhProperty::unpackValue(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd)
+{
+    Adesk::UInt8 type, isSet;
+    if (!unpack(pData, pEnd, type) || !unpack(pData, pEnd, isSet) || type > eVector)
+        return false;
+
+    reset(static_cast<GhProperty::Type>(type));
+    if (!isSet)
+        return true;
+
+    switch (m_type)
+    {
+    case eInt:
+    {
+        Adesk::UInt32 v;
+        if (!unpack(pData, pEnd, v))
+            return false;
+        m_data.m_int = static_cast<Adesk::Int32>(v);
+        break;
+    }
+    case eReal:
+        if (!unpack(pData, pEnd, m_data.m_real))
+            return false;
+        break;
+    case eBool:
+    {
+        Adesk::UInt8 v;
+        if (!unpack(pData, pEnd, v))
+            return false;
+        m_data.m_bool = v != 0;
+        break;
+    }
+    case eString:
+    {
+        std::vector<ACHAR> str;
+        if (!unpackString(pData, pEnd, str))
+            return false;
+        assignString(str.data(), static_cast<Adesk::UInt32>(str.size()));
+        break;
+    }
+    case ePoint:
+    case eVector:
+        for (double& v : m_data.m_xyz)
+        {
+            if (!unpack(pData, pEnd, v))
+                return false;
+        }
+        break;
+    }
+    m_isSet = !isEmpty();
+    return true;
 }
@@ -1,7 +1,8 @@
 #pragma once
 
 #include "Export.h"
-#include <memory>
+
+#include <vector>
 
 class AcGeVector3d;
 class AcGePoint3d;
@@ -23,7 +24,9 @@ public:
     GhProperty();
     GhProperty(Type type);
     GhProperty(const GhProperty&);
+    GhProperty(GhProperty&&) noexcept;
     GhProperty& operator =(const GhProperty& other);
+    GhProperty& operator =(GhProperty&& other) noexcept;
     ~GhProperty();
 
     GhProperty(int);
@@ -54,7 +57,45 @@ public:
     Acad::ErrorStatus dwgOutFields(AcDbDwgFiler*) const;
     Acad::ErrorStatus dwgInFields(AcDbDwgFiler*);
 
+    // packed form used by the value block of DbGrasshopperData
+    void packValue(std::vector<Adesk::UInt8>& buffer) const;
+    bool unpackValue(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd);
+    // moves past one packed value without decoding it, false if it is truncated or malformed
+    static bool skipValue(const Adesk::UInt8*& pData, const Adesk::UInt8* pEnd);
+
 private:
-    class Impl;
-    std::unique_ptr<Impl> m_pImpl = nullptr;
+    // strings up to kInlineLength - 1 characters are kept inside the property,
+    // longer ones go to a single heap buffer owned by the property
+    enum { kInlineLength = 16 };
+
+    union Data
+    {
+        int m_int;
+        double m_real;
+        bool m_bool;
+        double m_xyz[3];
+        ACHAR m_chars[kInlineLength];
+        ACHAR* m_pChars;
+    };
+
+    template <typename T>
+    void getData(T&) const;
+    template <typename T>
+    void setData(const T&);
+    template <typename T>
+    bool getValueImpl(T&) const;
+    template <typename T>
+    bool setValueImpl(const T&);
+
+    const ACHAR* chars() const;
+    bool isHeapString() const;
+    void assignString(const ACHAR* str, Adesk::UInt32 length);
+    void copyFrom(const GhProperty& other);
+    void moveFrom(GhProperty& other);
+    void reset(Type type);
+
+    Data m_data;
+    Adesk::UInt32 m_length = 0;
+    Type m_type = eEmpty;
+    bool m_isSet = false;
 };
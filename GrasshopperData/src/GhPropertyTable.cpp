@@ -0,0 +1,107 @@
+#include "StdAfx.h"
+#include "GhPropertyTable.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+const ACHAR* GhPropertyTable::intern(const ACHAR* name)
+{
+    // node based, so pointers to the stored names stay valid
+    static std::unordered_set<std::wstring> s_names;
+    static std::mutex s_mutex;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_names.emplace(name).first->c_str();
+}
+
+std::vector<GhPropertyTable::Entry>::const_iterator GhPropertyTable::lowerBound(const ACHAR* name) const
+{
+    return std::lower_bound(m_entries.begin(), m_entries.end(), name,
+        [](const Entry& entry, const ACHAR* name) { return entry.name != name && wcscmp(entry.name, name) < 0; });
+}
+
+size_t GhPropertyTable::indexOf(const ACHAR* name) const
+{
+    auto i = lowerBound(name);
+    if (i == m_entries.end() || (i->name != name && wcscmp(i->name, name) != 0))
+        return m_entries.size();
+    return i - m_entries.begin();
+}
+
+void GhPropertyTable::reserve(size_t size)
+{
+    m_entries.reserve(size);
+}
+
+void GhPropertyTable::clear()
+{
+    m_entries.clear();
+}
+
+size_t GhPropertyTable::size() const
+{
+    return m_entries.size();
+}
+
+bool GhPropertyTable::empty() const
+{
+    return m_entries.empty();
+}
+
+const GhProperty* GhPropertyTable::find(const ACHAR* name) const
+{
+    auto i = indexOf(name);
+    return i == m_entries.size() ? nullptr : &m_entries[i].value;
+}
+
+GhProperty* GhPropertyTable::find(const ACHAR* name)
+{
+    auto i = indexOf(name);
+    return i == m_entries.size() ? nullptr : &m_entries[i].value;
+}
+
+bool GhPropertyTable::insert(const ACHAR* name, const GhProperty& value)
+{
+    if (indexOf(name) != m_entries.size())
+        return false;
+    return insertInterned(intern(name), value) != nullptr;
+}
+
+GhProperty* GhPropertyTable::emplace(const ACHAR* name)
+{
+    if (indexOf(name) != m_entries.size())
+        return nullptr;
+    return insertInterned(intern(name), GhProperty());
+}
+
+GhProperty* GhPropertyTable::emplaceInterned(const ACHAR* internedName)
+{
+    return insertInterned(internedName, GhProperty());
+}
+
+GhProperty* GhPropertyTable::insertInterned(const ACHAR* internedName, const GhProperty& value)
+{
+    // names arriving in table order (as written by dwgOutFields) are appended directly
+    if (m_entries.empty() || wcscmp(m_entries.back().name, internedName) < 0)
+    {
+        m_entries.push_back(Entry{ internedName, value });
+        return &m_entries.back().value;
+    }
+
+    auto i = lowerBound(internedName);
+    if (i->name == internedName || wcscmp(i->name, internedName) == 0)
+        return nullptr;
+    return &m_entries.insert(i, Entry{ internedName, value })->value;
+}
+
+GhPropertyTable::const_iterator GhPropertyTable::begin() const
+{
+    return m_entries.begin();
+}
+
+GhPropertyTable::const_iterator GhPropertyTable::end() const
+{
+    return m_entries.end();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Export.h"
+#include "GhProperty.h"
+
+#include <vector>
+
+// Contiguous table of named properties, kept sorted by name so lookups
+// are binary searches. Names are interned process-wide, so hosts sharing
+// a definition share their name strings.
+class GH_IMPORTEXPORT GhPropertyTable
+{
+public:
+    struct Entry
+    {
+        const ACHAR* name;
+        GhProperty value;
+    };
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    GhPropertyTable() = default;
+    GhPropertyTable(const GhPropertyTable&) = default;
+    GhPropertyTable& operator=(const GhPropertyTable&) = default;
+
+    void reserve(size_t size);
+    void clear();
+    size_t size() const;
+    bool empty() const;
+
+    const GhProperty* find(const ACHAR* name) const;
+    GhProperty* find(const ACHAR* name);
+    bool insert(const ACHAR* name, const GhProperty& value);
+    GhProperty* emplace(const ACHAR* name);
+    // same as emplace for a name returned by intern, which is not interned again
+    GhProperty* emplaceInterned(const ACHAR* internedName);
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    static const ACHAR* intern(const ACHAR* name);
+
+private:
+    std::vector<Entry>::const_iterator lowerBound(const ACHAR* name) const;
+    size_t indexOf(const ACHAR* name) const;
+    GhProperty* insertInterned(const ACHAR* internedName, const GhProperty& value);
+
+    std::vector<Entry> m_entries;
+};
@@ -1,8 +1,10 @@
 #include "StdAfx.h"
 #include "GrasshopperOPMExtension.h"
+#include "GhDataIndex.h"
 #ifdef _DEBUG
 #include "DbGrasshopperData.h"
 #include "GhProperty.h"
+#include "GhDataTests.h"
 #endif
 
 class GhDataApp: public AcRxArxApp
@@ -19,6 +21,7 @@ public:
         AcRx::AppRetCode result = AcRxArxApp::On_kInitAppMsg(pAppData);
         acrxRegisterAppMDIAware(pAppData); // is able to work in MDI context
         registerGhOPMExtension();
+        registerGhDataIndex();
 #ifdef _DEBUG
         acutPrintf(_T("\nRegistered GhDataApp.dll"));
 #endif
@@ -27,6 +30,7 @@ public:
 
     virtual AcRx::AppRetCode On_kUnloadAppMsg(void* pAppData)
     {
+        unregisterGhDataIndex();
         unregisterGhOPMExtension();
         return AcRxArxApp::On_kUnloadAppMsg(pAppData);
     }
@@ -90,6 +94,11 @@ public:
 
         DbGrasshopperData::removeGrasshopperData(pDbObj);
     }
+
+    static void GhSampleTestGhData(void)
+    {
+        runGhDataTests();
+    }
 #endif
 };
 
@@ -98,4 +107,5 @@ IMPLEMENT_ARX_ENTRYPOINT(GhDataApp)
 #ifdef _DEBUG
 ACED_ARXCOMMAND_ENTRY_AUTO(GhDataApp, GhSample, AttachGh, AttachGh, ACRX_CMD_TRANSPARENT, NULL)
 ACED_ARXCOMMAND_ENTRY_AUTO(GhDataApp, GhSample, RemoveGh, RemoveGh, ACRX_CMD_TRANSPARENT, NULL)
+ACED_ARXCOMMAND_ENTRY_AUTO(GhDataApp, GhSample, TestGhData, TestGhData, ACRX_CMD_TRANSPARENT, NULL)
 #endif
@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 #include "GrasshopperData.h"
 #include "GhProperty.h"
+#include "GhDataIndex.h"
 #include "mgdinterop.h"
 
 using namespace System;
@@ -167,6 +168,24 @@ Teigha::DatabaseServices::ObjectId GrasshopperData::GetGrasshopperData(Teigha::D
     return ToObjectId(acObjId);
 }
 
+System::Collections::Generic::IDictionary<Teigha::DatabaseServices::ObjectId, Teigha::DatabaseServices::ObjectId>^ GrasshopperData::GetAllGrasshopperData(Teigha::DatabaseServices::Database^ database)
+{
+    if (nullptr == database)
+        throw gcnew ArgumentNullException("database");
+
+    AcDbObjectIdArray hostIds, ghDataIds;
+    auto pAcDb = getImpObjHelper<AcDbDatabase>(database->UnmanagedObject);
+    GhDataIndex::getGrasshopperData(pAcDb, hostIds, ghDataIds);
+
+    auto res = gcnew System::Collections::Generic::Dictionary<Teigha::DatabaseServices::ObjectId, Teigha::DatabaseServices::ObjectId>(ghDataIds.length());
+    for (int i = 0; i < ghDataIds.length(); ++i)
+    {
+        if (!hostIds[i].isNull())
+            res[ToObjectId(hostIds[i])] = ToObjectId(ghDataIds[i]);
+    }
+    return res;
+}
+
 System::Object^ GrasshopperData::GetProperty(System::String^ propertyName)
 {
     auto pGhData = this->GetImpObj();
@@ -182,6 +201,43 @@ System::Boolean GrasshopperData::UpdateProperty(System::String^ propertyName, Sy
     return this->GetImpObj()->updateProperty(pStr, ghProp);
 }
 
+array<System::Object^>^ GrasshopperData::GetProperties(array<System::String^>^ propertyNames)
+{
+    if (nullptr == propertyNames)
+        throw gcnew ArgumentNullException("propertyNames");
+
+    std::vector<AcString> names;
+    names.reserve(propertyNames->Length);
+    for each (String^ propertyName in propertyNames)
+    {
+        pin_ptr<const wchar_t> pStr = PtrToStringChars(propertyName);
+        names.push_back(AcString(pStr));
+    }
+
+    std::vector<GhProperty> ghProps;
+    this->GetImpObj()->getProperties(names, ghProps);
+
+    auto res = gcnew array<System::Object^>(propertyNames->Length);
+    for (int i = 0; i < res->Length; ++i)
+        res[i] = ToSystemObject(ghProps[i]);
+    return res;
+}
+
+System::Int32 GrasshopperData::UpdateProperties(System::Collections::Generic::IDictionary<System::String^, System::Object^>^ values)
+{
+    if (nullptr == values)
+        throw gcnew ArgumentNullException("values");
+
+    GhPropertyArray ghProps;
+    ghProps.reserve(values->Count);
+    for each (System::Collections::Generic::KeyValuePair<String^, Object^> value in values)
+    {
+        pin_ptr<const wchar_t> pStr = PtrToStringChars(value.Key);
+        ghProps.emplace_back(AcString(pStr), ToGhProperty(value.Value));
+    }
+    return static_cast<System::Int32>(this->GetImpObj()->updateProperties(ghProps));
+}
+
 System::Boolean GrasshopperData::AddProperty(System::String^ propertyName, System::Object^ value)
 {
     pin_ptr<const wchar_t> pStr = PtrToStringChars(propertyName);
@@ -39,11 +39,14 @@ namespace GH_BC
 
         System::Object^ GetProperty(System::String^ propertyName);
         System::Boolean UpdateProperty(System::String^ propertyName, System::Object^ value);
+        array<System::Object^>^ GetProperties(array<System::String^>^ propertyNames);
+        System::Int32 UpdateProperties(System::Collections::Generic::IDictionary<System::String^, System::Object^>^ values);
         System::Boolean AddProperty(System::String^ propertyName, System::Object^ value);
         System::Boolean AddProperty(System::String^ propertyName, System::Type^ type);
         void ClearProperties();
 
         static Teigha::DatabaseServices::ObjectId GetGrasshopperData(Teigha::DatabaseServices::Entity^);
+        static System::Collections::Generic::IDictionary<Teigha::DatabaseServices::ObjectId, Teigha::DatabaseServices::ObjectId>^ GetAllGrasshopperData(Teigha::DatabaseServices::Database^);
         static void RemoveGrasshopperData(Teigha::DatabaseServices::Entity^);
         static System::Boolean AttachGrasshopperData(Teigha::DatabaseServices::Entity^, GrasshopperData^);
     };